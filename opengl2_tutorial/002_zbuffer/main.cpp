@@ -3,6 +3,7 @@
 #include <string>
 #include <fstream>
 #include <sstream>
+#include <vector>
 #include <gl/glew.h>
 #include <GLFW/glfw3.h>
 
@@ -63,6 +64,36 @@ int readShaderSource(GLuint shaderObj, std::string fileName)
     return 0;
 }
 
+// シェーダーのコンパイルやリンクに失敗したときにログを表示する
+void printInfoLog(GLuint object, bool isProgram)
+{
+    GLint length = 0;
+    if (isProgram)
+    {
+        glGetProgramiv(object, GL_INFO_LOG_LENGTH, &length);
+    }
+    else
+    {
+        glGetShaderiv(object, GL_INFO_LOG_LENGTH, &length);
+    }
+    if (length <= 1)
+    {
+        return;
+    }
+    std::vector<GLchar> log(length);
+    if (isProgram)
+    {
+        glGetProgramInfoLog(object, length, NULL, &log[0]);
+    }
+    else
+    {
+        glGetShaderInfoLog(object, length, NULL, &log[0]);
+    }
+    fprintf(stderr, "%s\n", &log[0]);
+}
+
+
+// 失敗したときは作ったオブジェクトを全部削除して-1を返す
 GLint makeShader(std::string vertexFileName, std::string fragmentFileName)
 {
     // シェーダーオブジェクト作成
@@ -74,8 +105,12 @@ GLint makeShader(std::string vertexFileName, std::string fragmentFileName)
     GLint compiled, linked;
 
     /* シェーダーのソースプログラムの読み込み */
-    if (readShaderSource(vertShaderObj, vertexFileName)) return -1;
-    if (readShaderSource(fragShaderObj, fragmentFileName)) return -1;
+    if (readShaderSource(vertShaderObj, vertexFileName) || readShaderSource(fragShaderObj, fragmentFileName))
+    {
+        glDeleteShader(vertShaderObj);
+        glDeleteShader(fragShaderObj);
+        return -1;
+    }
 
     /* バーテックスシェーダーのソースプログラムのコンパイル */
     glCompileShader(vertShaderObj);
@@ -83,6 +118,9 @@ GLint makeShader(std::string vertexFileName, std::string fragmentFileName)
     if (compiled == GL_FALSE)
     {
         fprintf(stderr, "Compile error in vertex shader.\n");
+        printInfoLog(vertShaderObj, false);
+        glDeleteShader(vertShaderObj);
+        glDeleteShader(fragShaderObj);
         return -1;
     }
 
@@ -92,6 +130,9 @@ GLint makeShader(std::string vertexFileName, std::string fragmentFileName)
     if (compiled == GL_FALSE)
     {
         fprintf(stderr, "Compile error in fragment shader.\n");
+        printInfoLog(fragShaderObj, false);
+        glDeleteShader(vertShaderObj);
+        glDeleteShader(fragShaderObj);
         return -1;
     }
 
@@ -112,6 +153,8 @@ GLint makeShader(std::string vertexFileName, std::string fragmentFileName)
     if (linked == GL_FALSE)
     {
         fprintf(stderr, "Link error.\n");
+        printInfoLog(shader, true);
+        glDeleteProgram(shader);
         return -1;
     }
 
@@ -161,6 +204,9 @@ int main()
         glfwPollEvents();
     }
 
+    // GL側のオブジェクトはコンテキストがあるうちに削除する
+    glDeleteProgram(shader);
+
     // GLFWの終了処理
     glfwTerminate();
 
@@ -0,0 +1,858 @@
+#include "stdafx.h"
+#include <iostream>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#ifndef _WIN32
+#include <csignal>
+#endif
+#include <gl/glew.h>
+#include <GLFW/glfw3.h>
+
+// glmの使う機能をインクルード
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+//using namespace glm;でもいいけどここでは一部のみ「glm::」を省力できるようにする
+using glm::vec3;
+using glm::vec4;
+using glm::mat4;
+
+
+GLFWwindow* initGLFW(int width, int height)
+{
+    // GLFW初期化
+    if (glfwInit() == GL_FALSE)
+    {
+        return nullptr;
+    }
+
+    // ウィンドウ生成
+    GLFWwindow* window = glfwCreateWindow(width, height, "OpenGL Sample", NULL, NULL);
+    if (!window)
+    {
+        glfwTerminate();
+        return nullptr;
+    }
+
+    // バージョン2.1指定
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 2);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
+
+    glfwMakeContextCurrent(window);
+    // キャプチャのコストを測りたいので垂直同期は切っておく
+    glfwSwapInterval(0);
+
+    // GLEW初期化
+    if (glewInit() != GLEW_OK)
+    {
+        return nullptr;
+    }
+
+    return window;
+}
+
+GLint readShaderSource(GLuint shaderObj, std::string fileName)
+{
+    //ファイルの読み込み
+    std::ifstream ifs(fileName);
+    if (!ifs)
+    {
+        std::cout << "error" << std::endl;
+        return -1;
+    }
+
+    std::string source;
+    std::string line;
+    while (getline(ifs, line))
+    {
+        source += line + "\n";
+    }
+
+    // シェーダのソースプログラムをシェーダオブジェクトへ読み込む
+    const GLchar *sourcePtr = (const GLchar *)source.c_str();
+    GLint length = source.length();
+    glShaderSource(shaderObj, 1, &sourcePtr, &length);
+
+    return 0;
+}
+
+// シェーダーのコンパイルやリンクに失敗したときにログを表示する
+void printInfoLog(GLuint object, bool isProgram)
+{
+    GLint length = 0;
+    if (isProgram)
+    {
+        glGetProgramiv(object, GL_INFO_LOG_LENGTH, &length);
+    }
+    else
+    {
+        glGetShaderiv(object, GL_INFO_LOG_LENGTH, &length);
+    }
+    if (length <= 1)
+    {
+        return;
+    }
+    std::vector<GLchar> log(length);
+    if (isProgram)
+    {
+        glGetProgramInfoLog(object, length, NULL, &log[0]);
+    }
+    else
+    {
+        glGetShaderInfoLog(object, length, NULL, &log[0]);
+    }
+    fprintf(stderr, "%s\n", &log[0]);
+}
+
+
+// 失敗したときは作ったオブジェクトを全部削除して-1を返す
+GLint makeShader(std::string vertexFileName, std::string fragmentFileName)
+{
+    // シェーダーオブジェクト作成
+    GLuint vertShaderObj = glCreateShader(GL_VERTEX_SHADER);
+    GLuint fragShaderObj = glCreateShader(GL_FRAGMENT_SHADER);
+    GLuint shader;
+
+    // シェーダーコンパイルとリンクの結果用変数
+    GLint compiled, linked;
+
+    /* シェーダーのソースプログラムの読み込み */
+    if (readShaderSource(vertShaderObj, vertexFileName) || readShaderSource(fragShaderObj, fragmentFileName))
+    {
+        glDeleteShader(vertShaderObj);
+        glDeleteShader(fragShaderObj);
+        return -1;
+    }
+
+    /* バーテックスシェーダーのソースプログラムのコンパイル */
+    glCompileShader(vertShaderObj);
+    glGetShaderiv(vertShaderObj, GL_COMPILE_STATUS, &compiled);
+    if (compiled == GL_FALSE)
+    {
+        fprintf(stderr, "Compile error in vertex shader.\n");
+        printInfoLog(vertShaderObj, false);
+        glDeleteShader(vertShaderObj);
+        glDeleteShader(fragShaderObj);
+        return -1;
+    }
+
+    /* フラグメントシェーダーのソースプログラムのコンパイル */
+    glCompileShader(fragShaderObj);
+    glGetShaderiv(fragShaderObj, GL_COMPILE_STATUS, &compiled);
+    if (compiled == GL_FALSE)
+    {
+        fprintf(stderr, "Compile error in fragment shader.\n");
+        printInfoLog(fragShaderObj, false);
+        glDeleteShader(vertShaderObj);
+        glDeleteShader(fragShaderObj);
+        return -1;
+    }
+
+    /* プログラムオブジェクトの作成 */
+    shader = glCreateProgram();
+
+    /* シェーダーオブジェクトのシェーダープログラムへの登録 */
+    glAttachShader(shader, vertShaderObj);
+    glAttachShader(shader, fragShaderObj);
+
+    /* シェーダーオブジェクトの削除 */
+    glDeleteShader(vertShaderObj);
+    glDeleteShader(fragShaderObj);
+
+    /* シェーダープログラムのリンク */
+    glLinkProgram(shader);
+    glGetProgramiv(shader, GL_LINK_STATUS, &linked);
+    if (linked == GL_FALSE)
+    {
+        fprintf(stderr, "Link error.\n");
+        printInfoLog(shader, true);
+        glDeleteProgram(shader);
+        return -1;
+    }
+
+    return shader;
+}
+
+
+// ---------------------------------------------------------------------------
+// PNG書き出し
+// 外部ライブラリを使わないように、無圧縮(stored)のdeflateブロックでPNGを作る。
+// ファイルは大きくなるが、エンコーダースレッドの負荷は小さい。
+// ---------------------------------------------------------------------------
+
+uint32_t crc32(uint32_t crc, const uint8_t* data, size_t length)
+{
+    static uint32_t table[256];
+    static bool initialized = false;
+    if (!initialized)
+    {
+        for (uint32_t n = 0; n < 256; ++n)
+        {
+            uint32_t c = n;
+            for (int k = 0; k < 8; ++k)
+            {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            table[n] = c;
+        }
+        initialized = true;
+    }
+
+    crc = ~crc;
+    for (size_t i = 0; i < length; ++i)
+    {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+void putUint32BE(std::vector<uint8_t>& out, uint32_t value)
+{
+    out.push_back((value >> 24) & 0xFF);
+    out.push_back((value >> 16) & 0xFF);
+    out.push_back((value >> 8) & 0xFF);
+    out.push_back(value & 0xFF);
+}
+
+void writePNGChunk(std::ofstream& ofs, const char* type, const std::vector<uint8_t>& data)
+{
+    std::vector<uint8_t> chunk;
+    putUint32BE(chunk, (uint32_t)data.size());
+    chunk.insert(chunk.end(), type, type + 4);
+    chunk.insert(chunk.end(), data.begin(), data.end());
+    // CRCはチャンクタイプとデータに対して計算する
+    putUint32BE(chunk, crc32(0, &chunk[4], chunk.size() - 4));
+    ofs.write((const char*)&chunk[0], chunk.size());
+}
+
+// glReadPixelsで読んだRGBA(下から上の行順)をPNGとして保存する
+bool writePNG(const std::string& fileName, int width, int height, const GLubyte* pixels)
+{
+    std::ofstream ofs(fileName, std::ios::binary);
+    if (!ofs)
+    {
+        return false;
+    }
+
+    const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    ofs.write((const char*)signature, 8);
+
+    std::vector<uint8_t> header;
+    putUint32BE(header, width);
+    putUint32BE(header, height);
+    header.push_back(8);    // ビット深度
+    header.push_back(6);    // カラータイプ RGBA
+    header.push_back(0);    // 圧縮方式
+    header.push_back(0);    // フィルタ方式
+    header.push_back(0);    // インターレースなし
+    writePNGChunk(ofs, "IHDR", header);
+
+    // 各行の先頭にフィルタ種別(0 = なし)を付けた生データ。OpenGLは下の行からなので上下反転する
+    size_t stride = (size_t)width * 4;
+    std::vector<uint8_t> raw;
+    raw.reserve((stride + 1) * height);
+    for (int y = height - 1; y >= 0; --y)
+    {
+        raw.push_back(0);
+        const GLubyte* row = pixels + stride * y;
+        raw.insert(raw.end(), row, row + stride);
+    }
+
+    // zlibストリーム(無圧縮ブロックの連続 + Adler-32)
+    std::vector<uint8_t> idat;
+    idat.push_back(0x78);
+    idat.push_back(0x01);
+    size_t offset = 0;
+    do
+    {
+        size_t blockSize = std::min<size_t>(raw.size() - offset, 65535);
+        bool last = offset + blockSize == raw.size();
+        idat.push_back(last ? 1 : 0);
+        idat.push_back(blockSize & 0xFF);
+        idat.push_back((blockSize >> 8) & 0xFF);
+        idat.push_back(~blockSize & 0xFF);
+        idat.push_back((~blockSize >> 8) & 0xFF);
+        idat.insert(idat.end(), raw.begin() + offset, raw.begin() + offset + blockSize);
+        offset += blockSize;
+    } while (offset < raw.size());
+
+    uint32_t a = 1, b = 0;
+    for (size_t i = 0; i < raw.size(); ++i)
+    {
+        a = (a + raw[i]) % 65521;
+        b = (b + a) % 65521;
+    }
+    putUint32BE(idat, (b << 16) | a);
+    writePNGChunk(ofs, "IDAT", idat);
+
+    writePNGChunk(ofs, "IEND", std::vector<uint8_t>());
+
+    return (bool)ofs;
+}
+
+
+// ---------------------------------------------------------------------------
+// エンコーダースレッド
+// レンダリングスレッドからフレームを受け取り、別スレッドでファイルやパイプへ書き出す。
+// バッファはプールで使い回し、空きが無いときはフレームを落としてレンダリングを止めない。
+// ---------------------------------------------------------------------------
+
+enum class CaptureOutput
+{
+    Raw,    // 1つのファイルにRGBAをそのまま連結
+    PNG,    // 連番PNG
+    Pipe,   // 外部エンコーダー(ffmpegなど)の標準入力へ流す
+};
+
+struct CapturedFrame
+{
+    int index;
+    std::vector<GLubyte> pixels;
+};
+
+class FrameEncoder
+{
+public:
+    FrameEncoder(int width, int height, CaptureOutput output, std::string target, int poolSize)
+        : width(width), height(height), output(output), target(target)
+    {
+        for (int i = 0; i < poolSize; ++i)
+        {
+            std::unique_ptr<CapturedFrame> frame(new CapturedFrame());
+            frame->pixels.resize((size_t)width * height * 4);
+            freeFrames.push_back(std::move(frame));
+        }
+
+        if (output == CaptureOutput::Raw)
+        {
+            rawFile = fopen(target.c_str(), "wb");
+        }
+        else if (output == CaptureOutput::Pipe)
+        {
+#ifdef _WIN32
+            pipe = _popen(target.c_str(), "wb");
+#else
+            // 外部エンコーダーが終了していても書き込みでプロセスが落ちないようにする(書き込みはエラーになる)
+            signal(SIGPIPE, SIG_IGN);
+            pipe = popen(target.c_str(), "w");
+#endif
+        }
+
+        worker = std::thread(&FrameEncoder::run, this);
+    }
+
+    ~FrameEncoder()
+    {
+        finish();
+    }
+
+    // 出力先を開けたか(連番PNGはフレームごとに開くので常にtrue)
+    bool isOpen() const
+    {
+        switch (output)
+        {
+        case CaptureOutput::Raw:
+            return rawFile != nullptr;
+        case CaptureOutput::Pipe:
+            return pipe != nullptr;
+        default:
+            return true;
+        }
+    }
+
+    // キューに残っているフレームを書き終えるまで待ち、出力を閉じる
+    void finish()
+    {
+        if (!worker.joinable())
+        {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        queued.notify_all();
+        worker.join();
+
+        if (rawFile)
+        {
+            fclose(rawFile);
+            rawFile = nullptr;
+        }
+        if (pipe)
+        {
+#ifdef _WIN32
+            _pclose(pipe);
+#else
+            pclose(pipe);
+#endif
+            pipe = nullptr;
+        }
+    }
+
+    // 空きバッファを取り出す。空きが無ければnullptr(読み出しはするがエンコーダーには渡さない)
+    std::unique_ptr<CapturedFrame> acquire()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (freeFrames.empty())
+        {
+            return nullptr;
+        }
+        std::unique_ptr<CapturedFrame> frame = std::move(freeFrames.back());
+        freeFrames.pop_back();
+        return frame;
+    }
+
+    // 使わなかったバッファをプールに戻す
+    void release(std::unique_ptr<CapturedFrame> frame)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        freeFrames.push_back(std::move(frame));
+    }
+
+    void submit(std::unique_ptr<CapturedFrame> frame)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending.push_back(std::move(frame));
+        }
+        queued.notify_one();
+    }
+
+    int writtenFrames()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return written;
+    }
+
+    int failedFrames()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return failed;
+    }
+
+    double writeSeconds()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return writeTime;
+    }
+
+private:
+    void run()
+    {
+        for (;;)
+        {
+            std::unique_ptr<CapturedFrame> frame;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                queued.wait(lock, [this] { return stopping || !pending.empty(); });
+                // 終了要求が来ても溜まっているフレームは全部書き出す
+                if (pending.empty())
+                {
+                    return;
+                }
+                frame = std::move(pending.front());
+                pending.pop_front();
+            }
+
+            double start = glfwGetTime();
+            bool succeeded = write(*frame);
+            double elapsed = glfwGetTime() - start;
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (succeeded)
+            {
+                ++written;
+                writeTime += elapsed;
+            }
+            else
+            {
+                ++failed;
+            }
+            freeFrames.push_back(std::move(frame));
+        }
+    }
+
+    // 書き出せたらtrueを返す
+    bool write(const CapturedFrame& frame)
+    {
+        size_t size = frame.pixels.size();
+        switch (output)
+        {
+        case CaptureOutput::Raw:
+            return rawFile && fwrite(&frame.pixels[0], 1, size, rawFile) == size;
+        case CaptureOutput::PNG:
+        {
+            char fileName[256];
+            snprintf(fileName, sizeof(fileName), "%s_%05d.png", target.c_str(), frame.index);
+            if (!writePNG(fileName, width, height, &frame.pixels[0]))
+            {
+                fprintf(stderr, "Failed to write %s.\n", fileName);
+                return false;
+            }
+            return true;
+        }
+        case CaptureOutput::Pipe:
+            return pipe && fwrite(&frame.pixels[0], 1, size, pipe) == size;
+        }
+        return false;
+    }
+
+    int width, height;
+    CaptureOutput output;
+    std::string target;
+    FILE* rawFile = nullptr;
+    FILE* pipe = nullptr;
+
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable queued;
+    std::deque<std::unique_ptr<CapturedFrame>> pending;
+    std::vector<std::unique_ptr<CapturedFrame>> freeFrames;
+    bool stopping = false;
+    int written = 0;
+    int failed = 0;
+    double writeTime = 0.0;
+};
+
+
+// ---------------------------------------------------------------------------
+// PBOのリングによる非同期読み出し
+// フレームiではPBO[i % ringSize]にglReadPixelsを発行するだけで、CPUへのコピーは
+// ringSize - 1フレーム後にglMapBufferで行う。その頃にはGPUの転送は終わっているので
+// glReadPixelsを直接クライアントメモリへ行うときのような同期待ちが起きない。
+// ---------------------------------------------------------------------------
+
+class PBOCapture
+{
+public:
+    PBOCapture(int width, int height, int ringSize)
+        : width(width), height(height), pbos(ringSize), scratch((size_t)width * height * 4)
+    {
+        GLsizeiptr size = (GLsizeiptr)width * height * 4;
+        glGenBuffers(ringSize, &pbos[0]);
+        for (GLuint pbo : pbos)
+        {
+            // GL_STREAM_READ: GPUが書いてCPUが1回読む用途
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+            glBufferData(GL_PIXEL_PACK_BUFFER, size, NULL, GL_STREAM_READ);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+
+    ~PBOCapture()
+    {
+        glDeleteBuffers(pbos.size(), &pbos[0]);
+    }
+
+    // 現在のバックバッファの読み出しを発行し、一番古いPBOの中身をエンコーダーへ渡す
+    // 戻り値: エンコーダーに渡せずに捨てたフレーム数
+    int capture(FrameEncoder& encoder)
+    {
+        int ringSize = pbos.size();
+
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[issued % ringSize]);
+        // PBOがバインドされているので最後の引数はバッファ内のオフセットになり、すぐに戻る
+        glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, (void*)0);
+        ++issued;
+
+        int dropped = 0;
+        if (issued >= ringSize)
+        {
+            dropped = collect(issued - ringSize, encoder);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        return dropped;
+    }
+
+    // 終了時にまだ読んでいないPBOを全部回収する
+    int flush(FrameEncoder& encoder)
+    {
+        int ringSize = pbos.size();
+        int first = issued - ringSize + 1;
+        int dropped = 0;
+        for (int frame = first < 0 ? 0 : first; frame < issued; ++frame)
+        {
+            dropped += collect(frame, encoder);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        return dropped;
+    }
+
+private:
+    int collect(int frameIndex, FrameEncoder& encoder)
+    {
+        // 空きバッファが無くてもマップとコピーはしないと計測にならないので、作業用バッファに読み捨てる
+        std::unique_ptr<CapturedFrame> frame = encoder.acquire();
+        GLubyte* pixels = frame ? &frame->pixels[0] : &scratch[0];
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[frameIndex % pbos.size()]);
+        const GLubyte* mapped = (const GLubyte*)glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+        if (!mapped)
+        {
+            // 読めなかったフレームは捨てる。バッファはプールに戻しておく
+            if (frame)
+            {
+                encoder.release(std::move(frame));
+            }
+            return 1;
+        }
+        memcpy(pixels, mapped, scratch.size());
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+
+        if (!frame)
+        {
+            return 1;
+        }
+        frame->index = frameIndex;
+        encoder.submit(std::move(frame));
+        return 0;
+    }
+
+    int width, height;
+    std::vector<GLuint> pbos;
+    std::vector<GLubyte> scratch;
+    int issued = 0;
+};
+
+
+// 比較用: PBOを使わずにその場でglReadPixelsする(GPUの完了待ちが発生する)
+// 戻り値: エンコーダーに渡せずに捨てたフレーム数
+int captureSync(int width, int height, int frameIndex, FrameEncoder& encoder, std::vector<GLubyte>& scratch)
+{
+    // 空きバッファが無くても読み出しは必ず行い、エンコーダーへの受け渡しだけを省く
+    std::unique_ptr<CapturedFrame> frame = encoder.acquire();
+    GLubyte* pixels = frame ? &frame->pixels[0] : &scratch[0];
+
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+
+    if (!frame)
+    {
+        return 1;
+    }
+    frame->index = frameIndex;
+    encoder.submit(std::move(frame));
+    return 0;
+}
+
+
+// 計測フェーズ
+enum class CaptureMode
+{
+    None,   // キャプチャなし
+    Sync,   // 同期glReadPixels
+    PBO,    // PBOリング
+};
+
+struct PhaseResult
+{
+    const char* name;
+    double frameSeconds = 0.0;      // フレームループ全体の時間
+    double captureSeconds = 0.0;    // キャプチャ処理にかかったCPU時間
+    int frames = 0;
+    int dropped = 0;                // エンコーダーに渡せなかったフレーム数
+};
+
+
+// 使い方: 005_pbo_capture [raw|png|pipe] [計測フレーム数] [PBOの数] [出力先]
+int main(int argc, char* argv[])
+{
+    GLint width = 640, height = 480;
+
+    std::string outputName = argc > 1 ? argv[1] : "png";
+    int phaseFrames = argc > 2 ? atoi(argv[2]) : 300;
+    int ringSize = argc > 3 ? atoi(argv[3]) : 3;
+    if (ringSize < 2) ringSize = 2;
+
+    CaptureOutput output = CaptureOutput::PNG;
+    std::string target = "capture";
+    if (outputName == "raw")
+    {
+        output = CaptureOutput::Raw;
+        target = "capture.rgba";
+    }
+    else if (outputName == "pipe")
+    {
+        output = CaptureOutput::Pipe;
+        // glReadPixelsの結果は上下逆なのでvflipする
+        std::ostringstream cmd;
+        cmd << "ffmpeg -y -loglevel error -f rawvideo -pix_fmt rgba -s " << width << "x" << height
+            << " -r 60 -i - -vf vflip -pix_fmt yuv420p capture.mp4";
+        target = cmd.str();
+    }
+    if (argc > 4)
+    {
+        target = argv[4];
+    }
+    if (phaseFrames <= 0)
+    {
+        fprintf(stderr, "Frame count must be positive: %s\n", argv[2]);
+        return -1;
+    }
+
+    // エンコーダーのバッファはPBOの数より少し多めに用意しておく
+    FrameEncoder encoder(width, height, output, target, ringSize * 2 + 2);
+    if (!encoder.isOpen())
+    {
+        fprintf(stderr, "Failed to open %s.\n", target.c_str());
+        return -1;
+    }
+
+    GLFWwindow* window = initGLFW(width, height);
+
+    GLint shader = makeShader("shader.vert", "shader.frag");
+
+    // 4枚のポリゴンから成る三角錐(003_glmと同じ形)
+    std::vector<vec3> positions = {
+        vec3( 0, 0, 1),vec3(-1,-1, 0),vec3( 1, 0, 0),
+        vec3( 0, 0, 1),vec3( 1, 0, 0),vec3( 0, 1, 0),
+        vec3( 0, 0, 1),vec3( 0, 1, 0),vec3(-1,-1, 0),
+        vec3(-1,-1, 0),vec3( 0, 1, 0),vec3( 1, 0, 0),
+    };
+    std::vector<vec4> colors;
+    vec4 faceColor[4] = { vec4(1,0,0,1), vec4(0,1,0,1), vec4(0,0,1,1), vec4(1,1,0,1) };
+    for (int i = 0; i < 4; ++i)
+    {
+        colors.insert(colors.end(), 3, faceColor[i]);
+    }
+
+    GLint positionLocation = glGetAttribLocation(shader, "position");
+    GLint colorLocation = glGetAttribLocation(shader, "color");
+    GLuint buffers[2];
+    glGenBuffers(2, &buffers[0]);
+    glBindBuffer(GL_ARRAY_BUFFER, buffers[0]);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vec3) * positions.size(), &positions[0], GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, buffers[1]);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vec4) * colors.size(), &colors[0], GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    GLuint matrixID = glGetUniformLocation(shader, "MVP");
+
+    // PBOはglfwTerminateの前に削除したいのでスコープを切る
+    {
+        PBOCapture pboCapture(width, height, ringSize);
+        std::vector<GLubyte> syncScratch((size_t)width * height * 4);
+
+        CaptureMode modes[3] = { CaptureMode::None, CaptureMode::Sync, CaptureMode::PBO };
+        PhaseResult results[3];
+        results[0].name = "no capture";
+        results[1].name = "sync glReadPixels";
+        results[2].name = "PBO ring";
+
+        int phase = 0;
+        int frameIndex = 0;
+        double phaseStart = glfwGetTime();
+
+        // フレームループ
+        while (glfwWindowShouldClose(window) == GL_FALSE && phase < 3)
+        {
+            glUseProgram(shader);
+
+            glEnable(GL_DEPTH_TEST);
+            glDepthFunc(GL_LESS);
+            glClearColor(0.2f, 0.2f, 0.2f, 0.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            // 毎フレーム違う絵になるように回転させる
+            mat4 modelMat = glm::rotate(mat4(1.0f), frameIndex * 0.02f, vec3(0.0f, 0.0f, 1.0f));
+
+            // View行列を計算
+            mat4 viewMat = glm::lookAt(
+                vec3(1.0, 2.0, 6.0), // ワールド空間でのカメラの座標
+                vec3(0.0, 0.0, 0.0), // 見ている位置の座標
+                vec3(0.0, 0.0, 1.0)  // 上方向を示す。(0,1.0,0)に設定するとy軸が上になります
+            );
+
+            // Projection行列を計算
+            mat4 projectionMat = glm::perspective(
+                glm::radians(45.0f), // ズームの度合い(通常90～30)
+                (GLfloat)width / (GLfloat)height,		// アスペクト比
+                0.1f,		// 近くのクリッピング平面
+                100.0f		// 遠くのクリッピング平面
+            );
+
+            // ModelViewProjection行列を計算
+            mat4 mvpMat = projectionMat * viewMat* modelMat;
+            glUniformMatrix4fv(matrixID, 1, GL_FALSE, &mvpMat[0][0]);
+
+            glEnableVertexAttribArray(positionLocation);
+            glBindBuffer(GL_ARRAY_BUFFER, buffers[0]);
+            glVertexAttribPointer(positionLocation, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
+            glEnableVertexAttribArray(colorLocation);
+            glBindBuffer(GL_ARRAY_BUFFER, buffers[1]);
+            glVertexAttribPointer(colorLocation, 4, GL_FLOAT, GL_FALSE, 0, (void*)0);
+            glDrawArrays(GL_TRIANGLES, 0, positions.size());
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+            // スワップ前にバックバッファを読む
+            double captureStart = glfwGetTime();
+            switch (modes[phase])
+            {
+            case CaptureMode::None:
+                break;
+            case CaptureMode::Sync:
+                results[phase].dropped += captureSync(width, height, frameIndex, encoder, syncScratch);
+                break;
+            case CaptureMode::PBO:
+                results[phase].dropped += pboCapture.capture(encoder);
+                break;
+            }
+            results[phase].captureSeconds += glfwGetTime() - captureStart;
+
+            // ダブルバッファのスワップ
+            glfwSwapBuffers(window);
+            glfwPollEvents();
+
+            ++frameIndex;
+            if (++results[phase].frames == phaseFrames)
+            {
+                double now = glfwGetTime();
+                results[phase].frameSeconds = now - phaseStart;
+                phaseStart = now;
+                ++phase;
+            }
+        }
+
+        // 残っているPBOを回収してからエンコーダーを待つ
+        results[2].dropped += pboCapture.flush(encoder);
+        encoder.finish();
+
+        printf("capture overhead (%d frames per phase, %d PBOs)\n", phaseFrames, ringSize);
+        for (int i = 0; i < phase; ++i)
+        {
+            double frameMs = results[i].frameSeconds * 1000.0 / results[i].frames;
+            double captureMs = results[i].captureSeconds * 1000.0 / results[i].frames;
+            // 捨てたフレームがあっても読み出し自体は毎フレーム行っているので計測値は有効
+            printf("  %-18s %8.3f ms/frame  capture %8.3f ms/frame  overhead %+8.3f ms/frame  dropped %d/%d\n",
+                results[i].name, frameMs, captureMs,
+                frameMs - results[0].frameSeconds * 1000.0 / results[0].frames,
+                results[i].dropped, results[i].frames);
+        }
+        int written = encoder.writtenFrames();
+        printf("  encoder: %d frames written, %d failed, %.3f ms/frame on encoder thread\n",
+            written, encoder.failedFrames(), written ? encoder.writeSeconds() * 1000.0 / written : 0.0);
+
+        glDeleteBuffers(2, &buffers[0]);
+    }
+
+    glDeleteProgram(shader);
+
+    // GLFWの終了処理
+    glfwTerminate();
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,10 @@
+#version 120
+    
+//
+// shader.frag
+//
+    
+void main(void)
+{
+    gl_FragColor = gl_Color;
+}
\ No newline at end of file
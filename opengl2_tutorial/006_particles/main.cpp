@@ -0,0 +1,908 @@
+#include "stdafx.h"
+#include <iostream>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <gl/glew.h>
+#include <GLFW/glfw3.h>
+
+// glmの使う機能をインクルード
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+// SSE2が使える環境ではパーティクルの更新を4つずつまとめて行う
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PARTICLE_USE_SSE 1
+#include <emmintrin.h>
+#else
+#define PARTICLE_USE_SSE 0
+#endif
+
+//using namespace glm;でもいいけどここでは一部のみ「glm::」を省力できるようにする
+using glm::vec2;
+using glm::vec3;
+using glm::vec4;
+using glm::mat4;
+
+
+GLFWwindow* initGLFW(int width, int height)
+{
+    // GLFW初期化
+    if (glfwInit() == GL_FALSE)
+    {
+        return nullptr;
+    }
+
+    // ウィンドウ生成
+    GLFWwindow* window = glfwCreateWindow(width, height, "OpenGL Sample", NULL, NULL);
+    if (!window)
+    {
+        glfwTerminate();
+        return nullptr;
+    }
+
+    // バージョン2.1指定
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 2);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
+
+    glfwMakeContextCurrent(window);
+    glfwSwapInterval(0);
+
+    // GLEW初期化
+    if (glewInit() != GLEW_OK)
+    {
+        return nullptr;
+    }
+
+    return window;
+}
+
+GLint readShaderSource(GLuint shaderObj, std::string fileName)
+{
+    //ファイルの読み込み
+    std::ifstream ifs(fileName);
+    if (!ifs)
+    {
+        std::cout << "error" << std::endl;
+        return -1;
+    }
+
+    std::string source;
+    std::string line;
+    while (getline(ifs, line))
+    {
+        source += line + "\n";
+    }
+
+    // シェーダのソースプログラムをシェーダオブジェクトへ読み込む
+    const GLchar *sourcePtr = (const GLchar *)source.c_str();
+    GLint length = source.length();
+    glShaderSource(shaderObj, 1, &sourcePtr, &length);
+
+    return 0;
+}
+
+// シェーダーのコンパイルやリンクに失敗したときにログを表示する
+void printInfoLog(GLuint object, bool isProgram)
+{
+    GLint length = 0;
+    if (isProgram)
+    {
+        glGetProgramiv(object, GL_INFO_LOG_LENGTH, &length);
+    }
+    else
+    {
+        glGetShaderiv(object, GL_INFO_LOG_LENGTH, &length);
+    }
+    if (length <= 1)
+    {
+        return;
+    }
+    std::vector<GLchar> log(length);
+    if (isProgram)
+    {
+        glGetProgramInfoLog(object, length, NULL, &log[0]);
+    }
+    else
+    {
+        glGetShaderInfoLog(object, length, NULL, &log[0]);
+    }
+    fprintf(stderr, "%s\n", &log[0]);
+}
+
+
+// 失敗したときは作ったオブジェクトを全部削除して-1を返す
+GLint makeShader(std::string vertexFileName, std::string fragmentFileName)
+{
+    // シェーダーオブジェクト作成
+    GLuint vertShaderObj = glCreateShader(GL_VERTEX_SHADER);
+    GLuint fragShaderObj = glCreateShader(GL_FRAGMENT_SHADER);
+    GLuint shader;
+
+    // シェーダーコンパイルとリンクの結果用変数
+    GLint compiled, linked;
+
+    /* シェーダーのソースプログラムの読み込み */
+    if (readShaderSource(vertShaderObj, vertexFileName) || readShaderSource(fragShaderObj, fragmentFileName))
+    {
+        glDeleteShader(vertShaderObj);
+        glDeleteShader(fragShaderObj);
+        return -1;
+    }
+
+    /* バーテックスシェーダーのソースプログラムのコンパイル */
+    glCompileShader(vertShaderObj);
+    glGetShaderiv(vertShaderObj, GL_COMPILE_STATUS, &compiled);
+    if (compiled == GL_FALSE)
+    {
+        fprintf(stderr, "Compile error in vertex shader.\n");
+        printInfoLog(vertShaderObj, false);
+        glDeleteShader(vertShaderObj);
+        glDeleteShader(fragShaderObj);
+        return -1;
+    }
+
+    /* フラグメントシェーダーのソースプログラムのコンパイル */
+    glCompileShader(fragShaderObj);
+    glGetShaderiv(fragShaderObj, GL_COMPILE_STATUS, &compiled);
+    if (compiled == GL_FALSE)
+    {
+        fprintf(stderr, "Compile error in fragment shader.\n");
+        printInfoLog(fragShaderObj, false);
+        glDeleteShader(vertShaderObj);
+        glDeleteShader(fragShaderObj);
+        return -1;
+    }
+
+    /* プログラムオブジェクトの作成 */
+    shader = glCreateProgram();
+
+    /* シェーダーオブジェクトのシェーダープログラムへの登録 */
+    glAttachShader(shader, vertShaderObj);
+    glAttachShader(shader, fragShaderObj);
+
+    /* シェーダーオブジェクトの削除 */
+    glDeleteShader(vertShaderObj);
+    glDeleteShader(fragShaderObj);
+
+    /* シェーダープログラムのリンク */
+    glLinkProgram(shader);
+    glGetProgramiv(shader, GL_LINK_STATUS, &linked);
+    if (linked == GL_FALSE)
+    {
+        fprintf(stderr, "Link error.\n");
+        printInfoLog(shader, true);
+        glDeleteProgram(shader);
+        return -1;
+    }
+
+    return shader;
+}
+
+
+// ---------------------------------------------------------------------------
+// スレッドプール
+// parallelForで範囲をchunk単位に分け、ワーカーと呼び出し元のスレッドで処理する。
+// ---------------------------------------------------------------------------
+
+class ThreadPool
+{
+public:
+    typedef std::function<void(size_t begin, size_t end, size_t chunkIndex)> Job;
+
+    explicit ThreadPool(int threadCount)
+    {
+        // 呼び出し元のスレッドも働くのでワーカーは1つ少なくてよい
+        for (int i = 1; i < threadCount; ++i)
+        {
+            workers.push_back(std::thread(&ThreadPool::run, this));
+        }
+    }
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& worker : workers)
+        {
+            worker.join();
+        }
+    }
+
+    int threadCount() const
+    {
+        return workers.size() + 1;
+    }
+
+    // [0, count)を処理し終わるまで戻らない
+    void parallelFor(size_t count, size_t chunkSize, const Job& body)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            job = &body;
+            jobCount = count;
+            jobChunkSize = chunkSize;
+            nextChunk = 0;
+            activeWorkers = workers.size();
+            ++generation;
+        }
+        wake.notify_all();
+
+        work();
+
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this] { return activeWorkers == 0; });
+        job = nullptr;
+    }
+
+private:
+    void run()
+    {
+        size_t seenGeneration = 0;
+        for (;;)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&] { return stopping || generation != seenGeneration; });
+                if (stopping)
+                {
+                    return;
+                }
+                seenGeneration = generation;
+            }
+
+            work();
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--activeWorkers == 0)
+            {
+                done.notify_one();
+            }
+        }
+    }
+
+    void work()
+    {
+        for (;;)
+        {
+            size_t chunkIndex = nextChunk.fetch_add(1);
+            size_t begin = chunkIndex * jobChunkSize;
+            if (begin >= jobCount)
+            {
+                return;
+            }
+            (*job)(begin, std::min(begin + jobChunkSize, jobCount), chunkIndex);
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    const Job* job = nullptr;
+    size_t jobCount = 0;
+    size_t jobChunkSize = 1;
+    std::atomic<size_t> nextChunk;
+    size_t generation = 0;
+    int activeWorkers = 0;
+    bool stopping = false;
+};
+
+
+// ---------------------------------------------------------------------------
+// パーティクルのパラメーター(simulate.fragと同じ値を使う)
+// ---------------------------------------------------------------------------
+
+struct ParticleParams
+{
+    vec3 emitter = vec3(0.0f, 0.0f, 0.0f);
+    float spread = 0.2f;        // エミッターの大きさ
+    float gravity = -2.0f;      // z軸が上
+};
+
+
+// ---------------------------------------------------------------------------
+// CPU版パーティクルシステム
+// 座標・速度・寿命を要素ごとの配列(SoA)で持つので、SIMDで4つずつ連続して読み書きできる。
+// 描画時もこの配列をそのままVBOへ転送する。
+// ---------------------------------------------------------------------------
+
+class ParticleSystem
+{
+public:
+    ParticleSystem(size_t particleCount, const ParticleParams& params)
+        : params(params)
+    {
+        // SIMDで端数処理をしなくて済むように4の倍数にそろえる
+        count = (particleCount + 3) & ~(size_t)3;
+        px.resize(count); py.resize(count); pz.resize(count);
+        vx.resize(count); vy.resize(count); vz.resize(count);
+        life.resize(count);
+
+        // 最初は寿命をばらばらにして、再生成のタイミングを分散させる
+        uint32_t rng = 2463534242u;
+        for (size_t i = 0; i < count; ++i)
+        {
+            px[i] = params.emitter.x + (randomFloat(rng) - 0.5f) * params.spread;
+            py[i] = params.emitter.y + (randomFloat(rng) - 0.5f) * params.spread;
+            pz[i] = params.emitter.z;
+            vx[i] = (randomFloat(rng) - 0.5f) * 2.0f;
+            vy[i] = (randomFloat(rng) - 0.5f) * 2.0f;
+            vz[i] = 3.0f + randomFloat(rng) * 2.0f;
+            life[i] = randomFloat(rng) * 3.0f;
+        }
+    }
+
+    size_t size() const
+    {
+        return count;
+    }
+
+    // 全パーティクルをスレッドプールで分担して更新する
+    void update(ThreadPool& pool, float dt, uint32_t frame)
+    {
+        const size_t chunkSize = 16384;
+        pool.parallelFor(count, chunkSize, [&](size_t begin, size_t end, size_t chunkIndex) {
+            updateRange(begin, end, dt, frame * 2654435761u + (uint32_t)chunkIndex * 40503u + 1u);
+        });
+    }
+
+    std::vector<float> px, py, pz;
+    std::vector<float> vx, vy, vz;
+    std::vector<float> life;
+
+private:
+    // 積分と、寿命が尽きたパーティクルの再生成(エミッション)
+    void updateRange(size_t begin, size_t end, float dt, uint32_t seed)
+    {
+#if PARTICLE_USE_SSE
+        const __m128 vdt = _mm_set1_ps(dt);
+        const __m128 gravityDt = _mm_set1_ps(params.gravity * dt);
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 half = _mm_set1_ps(0.5f);
+        const __m128 bounce = _mm_set1_ps(-0.5f);
+        const __m128 two = _mm_set1_ps(2.0f);
+        const __m128 three = _mm_set1_ps(3.0f);
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 spread = _mm_set1_ps(params.spread);
+        const __m128 emitterX = _mm_set1_ps(params.emitter.x);
+        const __m128 emitterY = _mm_set1_ps(params.emitter.y);
+        const __m128 emitterZ = _mm_set1_ps(params.emitter.z);
+
+        // レーンごとに別の乱数列(xorshift32)。0にならないように下位ビットを立てる
+        __m128i rng = _mm_set_epi32(seed * 747796405u | 1, seed * 2891336453u | 1, seed * 1181783497u | 1, seed | 1);
+
+        for (size_t i = begin; i < end; i += 4)
+        {
+            __m128 x = _mm_loadu_ps(&px[i]);
+            __m128 y = _mm_loadu_ps(&py[i]);
+            __m128 z = _mm_loadu_ps(&pz[i]);
+            __m128 velX = _mm_loadu_ps(&vx[i]);
+            __m128 velY = _mm_loadu_ps(&vy[i]);
+            __m128 velZ = _mm_loadu_ps(&vz[i]);
+            __m128 l = _mm_loadu_ps(&life[i]);
+
+            velZ = _mm_add_ps(velZ, gravityDt);
+            x = _mm_add_ps(x, _mm_mul_ps(velX, vdt));
+            y = _mm_add_ps(y, _mm_mul_ps(velY, vdt));
+            z = _mm_add_ps(z, _mm_mul_ps(velZ, vdt));
+
+            // 床で跳ね返る
+            __m128 below = _mm_cmplt_ps(z, zero);
+            z = select(below, _mm_sub_ps(zero, z), z);
+            velZ = select(below, _mm_mul_ps(velZ, bounce), velZ);
+
+            l = _mm_sub_ps(l, vdt);
+
+            // 寿命が尽きたレーンだけ新しい値に置き換える
+            __m128 dead = _mm_cmple_ps(l, zero);
+            if (_mm_movemask_ps(dead))
+            {
+                __m128 r0 = nextRandom(rng), r1 = nextRandom(rng), r2 = nextRandom(rng);
+                __m128 q0 = nextRandom(rng), q1 = nextRandom(rng), q2 = nextRandom(rng);
+                x = select(dead, _mm_add_ps(emitterX, _mm_mul_ps(_mm_sub_ps(r0, half), spread)), x);
+                y = select(dead, _mm_add_ps(emitterY, _mm_mul_ps(_mm_sub_ps(r1, half), spread)), y);
+                z = select(dead, emitterZ, z);
+                velX = select(dead, _mm_mul_ps(_mm_sub_ps(q0, half), two), velX);
+                velY = select(dead, _mm_mul_ps(_mm_sub_ps(q1, half), two), velY);
+                velZ = select(dead, _mm_add_ps(three, _mm_mul_ps(r2, two)), velZ);
+                l = select(dead, _mm_add_ps(one, _mm_mul_ps(q2, two)), l);
+            }
+
+            _mm_storeu_ps(&px[i], x);
+            _mm_storeu_ps(&py[i], y);
+            _mm_storeu_ps(&pz[i], z);
+            _mm_storeu_ps(&vx[i], velX);
+            _mm_storeu_ps(&vy[i], velY);
+            _mm_storeu_ps(&vz[i], velZ);
+            _mm_storeu_ps(&life[i], l);
+        }
+#else
+        uint32_t rng = seed | 1;
+        for (size_t i = begin; i < end; ++i)
+        {
+            vz[i] += params.gravity * dt;
+            px[i] += vx[i] * dt;
+            py[i] += vy[i] * dt;
+            pz[i] += vz[i] * dt;
+
+            // 床で跳ね返る
+            if (pz[i] < 0.0f)
+            {
+                pz[i] = -pz[i];
+                vz[i] *= -0.5f;
+            }
+
+            life[i] -= dt;
+            if (life[i] <= 0.0f)
+            {
+                px[i] = params.emitter.x + (randomFloat(rng) - 0.5f) * params.spread;
+                py[i] = params.emitter.y + (randomFloat(rng) - 0.5f) * params.spread;
+                pz[i] = params.emitter.z;
+                vx[i] = (randomFloat(rng) - 0.5f) * 2.0f;
+                vy[i] = (randomFloat(rng) - 0.5f) * 2.0f;
+                vz[i] = 3.0f + randomFloat(rng) * 2.0f;
+                life[i] = 1.0f + randomFloat(rng) * 2.0f;
+            }
+        }
+#endif
+    }
+
+#if PARTICLE_USE_SSE
+    static __m128 select(__m128 mask, __m128 a, __m128 b)
+    {
+        return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+    }
+
+    // xorshift32を4レーン同時に進め、[0, 1)のfloatにする
+    static __m128 nextRandom(__m128i& state)
+    {
+        state = _mm_xor_si128(state, _mm_slli_epi32(state, 13));
+        state = _mm_xor_si128(state, _mm_srli_epi32(state, 17));
+        state = _mm_xor_si128(state, _mm_slli_epi32(state, 5));
+        // 上位23ビットを仮数部に入れると[1, 2)になる
+        __m128i bits = _mm_or_si128(_mm_srli_epi32(state, 9), _mm_set1_epi32(0x3F800000));
+        return _mm_sub_ps(_mm_castsi128_ps(bits), _mm_set1_ps(1.0f));
+    }
+#endif
+
+    // xorshift32で[0, 1)のfloatを返す
+    static float randomFloat(uint32_t& state)
+    {
+        state ^= state << 13; state ^= state >> 17; state ^= state << 5;
+        return (float)(state >> 8) / (float)(1 << 24);
+    }
+
+    ParticleParams params;
+    size_t count;
+};
+
+
+// ---------------------------------------------------------------------------
+// CPU版の描画
+// 毎フレームglBufferDataでバッファを作り直して(orphaning)、前のフレームの描画が
+// 終わるのを待たずに書き込めるようにする。x, y, z, 寿命の配列を1つのVBOに並べて転送する。
+// ---------------------------------------------------------------------------
+
+class StreamedParticleBuffer
+{
+public:
+    StreamedParticleBuffer(GLint shader, size_t particleCount)
+        : count(particleCount)
+    {
+        glGenBuffers(1, &vbo);
+        locations[0] = glGetAttribLocation(shader, "positionX");
+        locations[1] = glGetAttribLocation(shader, "positionY");
+        locations[2] = glGetAttribLocation(shader, "positionZ");
+        locations[3] = glGetAttribLocation(shader, "life");
+    }
+
+    ~StreamedParticleBuffer()
+    {
+        glDeleteBuffers(1, &vbo);
+    }
+
+    void upload(const ParticleSystem& particles)
+    {
+        GLsizeiptr arraySize = sizeof(float) * count;
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glBufferData(GL_ARRAY_BUFFER, arraySize * 4, NULL, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, arraySize * 0, arraySize, &particles.px[0]);
+        glBufferSubData(GL_ARRAY_BUFFER, arraySize * 1, arraySize, &particles.py[0]);
+        glBufferSubData(GL_ARRAY_BUFFER, arraySize * 2, arraySize, &particles.pz[0]);
+        glBufferSubData(GL_ARRAY_BUFFER, arraySize * 3, arraySize, &particles.life[0]);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    void draw()
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        for (int i = 0; i < 4; ++i)
+        {
+            glEnableVertexAttribArray(locations[i]);
+            glVertexAttribPointer(locations[i], 1, GL_FLOAT, GL_FALSE, 0, (void*)(sizeof(float) * count * i));
+        }
+        glDrawArrays(GL_POINTS, 0, count);
+        for (int i = 0; i < 4; ++i)
+        {
+            glDisableVertexAttribArray(locations[i]);
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+private:
+    GLuint vbo;
+    GLint locations[4];
+    size_t count;
+};
+
+
+// ---------------------------------------------------------------------------
+// GPU版パーティクルシステム
+// 座標+寿命と速度をそれぞれ浮動小数点テクスチャに入れ、FBOへのレンダリングで更新する。
+// 読み込み用と書き込み用の2組を毎フレーム入れ替える(ピンポン)。
+// 描画は頂点シェーダーで位置テクスチャを読む(頂点テクスチャフェッチ)。
+// ---------------------------------------------------------------------------
+
+class GPUParticleSystem
+{
+public:
+    // 浮動小数点テクスチャ、FBO、頂点テクスチャフェッチが使えるか
+    static bool isSupported()
+    {
+        if (!GLEW_ARB_texture_float || !GLEW_EXT_framebuffer_object)
+        {
+            return false;
+        }
+        GLint vertexTextureUnits = 0;
+        glGetIntegerv(GL_MAX_VERTEX_TEXTURE_IMAGE_UNITS, &vertexTextureUnits);
+        // 位置と速度をgl_FragData[0], [1]へ同時に書き出す
+        GLint drawBuffers = 0;
+        glGetIntegerv(GL_MAX_DRAW_BUFFERS, &drawBuffers);
+        return vertexTextureUnits > 0 && drawBuffers >= 2;
+    }
+
+    GPUParticleSystem(const ParticleSystem& initial, const ParticleParams& params)
+        : params(params), count(initial.size())
+    {
+        side = (GLsizei)std::ceil(std::sqrt((double)count));
+
+        simShader = makeShader("simulate.vert", "simulate.frag");
+        drawShader = makeShader("particle_gpu.vert", "particle.frag");
+
+        // CPU版と同じ初期状態をRGBAに詰めて転送する
+        std::vector<float> positionData((size_t)side * side * 4, 0.0f);
+        std::vector<float> velocityData((size_t)side * side * 4, 0.0f);
+        for (size_t i = 0; i < count; ++i)
+        {
+            positionData[i * 4 + 0] = initial.px[i];
+            positionData[i * 4 + 1] = initial.py[i];
+            positionData[i * 4 + 2] = initial.pz[i];
+            positionData[i * 4 + 3] = initial.life[i];
+            velocityData[i * 4 + 0] = initial.vx[i];
+            velocityData[i * 4 + 1] = initial.vy[i];
+            velocityData[i * 4 + 2] = initial.vz[i];
+        }
+
+        glGenTextures(4, &textures[0][0]);
+        glGenFramebuffersEXT(2, fbos);
+        for (int i = 0; i < 2; ++i)
+        {
+            for (int j = 0; j < 2; ++j)
+            {
+                glBindTexture(GL_TEXTURE_2D, textures[i][j]);
+                // テクセル1つがパーティクル1つなので補間させない
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+                glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F_ARB, side, side, 0, GL_RGBA, GL_FLOAT,
+                    j == 0 ? &positionData[0] : &velocityData[0]);
+            }
+
+            glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, fbos[i]);
+            glFramebufferTexture2DEXT(GL_FRAMEBUFFER_EXT, GL_COLOR_ATTACHMENT0_EXT, GL_TEXTURE_2D, textures[i][0], 0);
+            glFramebufferTexture2DEXT(GL_FRAMEBUFFER_EXT, GL_COLOR_ATTACHMENT1_EXT, GL_TEXTURE_2D, textures[i][1], 0);
+            if (glCheckFramebufferStatusEXT(GL_FRAMEBUFFER_EXT) != GL_FRAMEBUFFER_COMPLETE_EXT)
+            {
+                fprintf(stderr, "Framebuffer for GPU particles is incomplete.\n");
+                valid = false;
+            }
+        }
+        glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, 0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        // 更新用の全画面四角形
+        vec2 quad[4] = { vec2(-1, -1), vec2(1, -1), vec2(-1, 1), vec2(1, 1) };
+        // 描画用に各パーティクルのテクセル中心の座標
+        std::vector<vec2> texCoords(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            texCoords[i] = vec2(((i % side) + 0.5f) / side, ((i / side) + 0.5f) / side);
+        }
+        glGenBuffers(2, buffers);
+        glBindBuffer(GL_ARRAY_BUFFER, buffers[0]);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, buffers[1]);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(vec2) * texCoords.size(), &texCoords[0], GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        valid = valid && simShader > 0 && drawShader > 0;
+    }
+
+    ~GPUParticleSystem()
+    {
+        glDeleteBuffers(2, buffers);
+        glDeleteFramebuffersEXT(2, fbos);
+        glDeleteTextures(4, &textures[0][0]);
+        if (simShader > 0) glDeleteProgram(simShader);
+        if (drawShader > 0) glDeleteProgram(drawShader);
+    }
+
+    bool isValid() const
+    {
+        return valid;
+    }
+
+    void update(float dt, uint32_t frame)
+    {
+        int src = current;
+        int dst = 1 - current;
+
+        glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, fbos[dst]);
+        GLenum drawBuffers[2] = { GL_COLOR_ATTACHMENT0_EXT, GL_COLOR_ATTACHMENT1_EXT };
+        glDrawBuffers(2, drawBuffers);
+        glViewport(0, 0, side, side);
+        glDisable(GL_DEPTH_TEST);
+        glDisable(GL_BLEND);
+
+        glUseProgram(simShader);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, textures[src][0]);
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, textures[src][1]);
+        glUniform1i(glGetUniformLocation(simShader, "positionTex"), 0);
+        glUniform1i(glGetUniformLocation(simShader, "velocityTex"), 1);
+        glUniform1f(glGetUniformLocation(simShader, "dt"), dt);
+        glUniform1f(glGetUniformLocation(simShader, "gravity"), params.gravity);
+        glUniform1f(glGetUniformLocation(simShader, "seed"), (frame % 1024) * 0.618034f);
+        glUniform3f(glGetUniformLocation(simShader, "emitter"), params.emitter.x, params.emitter.y, params.emitter.z);
+        glUniform1f(glGetUniformLocation(simShader, "spread"), params.spread);
+
+        GLint positionLocation = glGetAttribLocation(simShader, "position");
+        glBindBuffer(GL_ARRAY_BUFFER, buffers[0]);
+        glEnableVertexAttribArray(positionLocation);
+        glVertexAttribPointer(positionLocation, 2, GL_FLOAT, GL_FALSE, 0, (void*)0);
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        glDisableVertexAttribArray(positionLocation);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, 0);
+
+        current = dst;
+    }
+
+    void draw(const mat4& mvpMat, float pointScale)
+    {
+        glUseProgram(drawShader);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, textures[current][0]);
+        glUniform1i(glGetUniformLocation(drawShader, "positionTex"), 0);
+        glUniformMatrix4fv(glGetUniformLocation(drawShader, "MVP"), 1, GL_FALSE, &mvpMat[0][0]);
+        glUniform1f(glGetUniformLocation(drawShader, "pointScale"), pointScale);
+
+        GLint texCoordLocation = glGetAttribLocation(drawShader, "texCoord");
+        glBindBuffer(GL_ARRAY_BUFFER, buffers[1]);
+        glEnableVertexAttribArray(texCoordLocation);
+        glVertexAttribPointer(texCoordLocation, 2, GL_FLOAT, GL_FALSE, 0, (void*)0);
+        glDrawArrays(GL_POINTS, 0, count);
+        glDisableVertexAttribArray(texCoordLocation);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+private:
+    ParticleParams params;
+    size_t count;
+    GLsizei side;
+    GLuint textures[2][2];  // [ピンポン][0: 座標+寿命, 1: 速度]
+    GLuint fbos[2];
+    GLuint buffers[2];      // [0: 全画面四角形, 1: テクスチャ座標]
+    GLint simShader, drawShader;
+    int current = 0;
+    bool valid = true;
+};
+
+
+// 計測結果
+struct PathResult
+{
+    const char* name;
+    double updateSeconds = 0.0;     // 更新(CPUは積分+転送、GPUはシミュレーションパス)
+    double frameSeconds = 0.0;      // 更新と描画を含むフレーム全体
+    int frames = 0;
+};
+
+
+// 使い方: 006_particles [パーティクル数] [計測フレーム数]
+int main(int argc, char* argv[])
+{
+    GLint width = 640, height = 480;
+    long requestedCount = argc > 1 ? atol(argv[1]) : (1 << 20);
+    int benchFrames = argc > 2 ? atoi(argv[2]) : 300;
+    // 計測を再現できるように時間刻みは固定する
+    const float dt = 1.0f / 60.0f;
+
+    if (requestedCount <= 0 || benchFrames <= 0)
+    {
+        fprintf(stderr, "Particle count and bench frames must be positive.\n");
+        return -1;
+    }
+    size_t particleCount = (size_t)requestedCount;
+
+    GLFWwindow* window = initGLFW(width, height);
+
+    GLint shader = makeShader("particle.vert", "particle.frag");
+    GLuint matrixID = glGetUniformLocation(shader, "MVP");
+    GLuint pointScaleID = glGetUniformLocation(shader, "pointScale");
+
+    // バッファやテクスチャはglfwTerminateの前に削除したいのでスコープを切る
+    {
+        ParticleParams params;
+        ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()));
+        ParticleSystem particles(particleCount, params);
+        StreamedParticleBuffer particleBuffer(shader, particles.size());
+
+        GPUParticleSystem* gpuParticles = nullptr;
+        if (GPUParticleSystem::isSupported())
+        {
+            gpuParticles = new GPUParticleSystem(particles, params);
+            if (!gpuParticles->isValid())
+            {
+                delete gpuParticles;
+                gpuParticles = nullptr;
+            }
+        }
+        if (!gpuParticles)
+        {
+            printf("Float textures, vertex texture fetch or two draw buffers are not available; GPU path is skipped.\n");
+        }
+
+        PathResult results[2];
+        results[0].name = "CPU (SIMD + threads)";
+        results[1].name = "GPU (render to texture)";
+        int pathCount = gpuParticles ? 2 : 1;
+        int path = 0;
+        bool reported = false;
+        uint32_t frame = 0;
+
+        // View行列を計算
+        mat4 viewMat = glm::lookAt(
+            vec3(1.0, 2.0, 6.0), // ワールド空間でのカメラの座標
+            vec3(0.0, 0.0, 1.0), // 見ている位置の座標
+            vec3(0.0, 0.0, 1.0)  // 上方向を示す。(0,1.0,0)に設定するとy軸が上になります
+        );
+
+        // Projection行列を計算
+        mat4 projectionMat = glm::perspective(
+            glm::radians(45.0f), // ズームの度合い(通常90～30)
+            (GLfloat)width / (GLfloat)height,		// アスペクト比
+            0.1f,		// 近くのクリッピング平面
+            100.0f		// 遠くのクリッピング平面
+        );
+
+        mat4 mvpMat = projectionMat * viewMat;
+        // 画面の高さに対する点の大きさ
+        float pointScale = height * 0.02f;
+
+        // フレームループ
+        while (glfwWindowShouldClose(window) == GL_FALSE)
+        {
+            double frameStart = glfwGetTime();
+
+            // 更新
+            if (path == 0)
+            {
+                particles.update(pool, dt, frame);
+                particleBuffer.upload(particles);
+            }
+            else
+            {
+                gpuParticles->update(dt, frame);
+            }
+            // 計測のためにGPUの処理が終わるまで待つ
+            glFinish();
+            double updateEnd = glfwGetTime();
+
+            // 描画
+            glViewport(0, 0, width, height);
+            glClearColor(0.05f, 0.05f, 0.08f, 0.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            // ポイントスプライトを加算合成で描く。深度は書き込まない
+            glEnable(GL_POINT_SPRITE);
+            glEnable(GL_VERTEX_PROGRAM_POINT_SIZE);
+            glEnable(GL_BLEND);
+            glBlendFunc(GL_ONE, GL_ONE);
+            glDepthMask(GL_FALSE);
+
+            if (path == 0)
+            {
+                glUseProgram(shader);
+                glUniformMatrix4fv(matrixID, 1, GL_FALSE, &mvpMat[0][0]);
+                glUniform1f(pointScaleID, pointScale);
+                particleBuffer.draw();
+            }
+            else
+            {
+                gpuParticles->draw(mvpMat, pointScale);
+            }
+
+            glDepthMask(GL_TRUE);
+            glDisable(GL_BLEND);
+            glFinish();
+            double frameEnd = glfwGetTime();
+
+            // ダブルバッファのスワップ
+            glfwSwapBuffers(window);
+            glfwPollEvents();
+
+            ++frame;
+            if (!reported)
+            {
+                results[path].updateSeconds += updateEnd - frameStart;
+                results[path].frameSeconds += frameEnd - frameStart;
+                if (++results[path].frames == benchFrames)
+                {
+                    if (path + 1 < pathCount)
+                    {
+                        ++path;
+                    }
+                    else
+                    {
+                        // 計測が終わったら最後のパスのまま表示を続ける
+                        reported = true;
+                        printf("%zu particles, %d threads, %d frames per path\n",
+                            particles.size(), pool.threadCount(), benchFrames);
+                        for (int i = 0; i < pathCount; ++i)
+                        {
+                            double updated = (double)particles.size() * results[i].frames / results[i].updateSeconds;
+                            double rendered = (double)particles.size() * results[i].frames / results[i].frameSeconds;
+                            printf("  %-24s update %8.3f ms  frame %8.3f ms  %8.1f M updated/s  %8.1f M rendered/s\n",
+                                results[i].name,
+                                results[i].updateSeconds * 1000.0 / results[i].frames,
+                                results[i].frameSeconds * 1000.0 / results[i].frames,
+                                updated / 1e6, rendered / 1e6);
+                        }
+                    }
+                }
+            }
+        }
+
+        delete gpuParticles;
+    }
+
+    glDeleteProgram(shader);
+
+    // GLFWの終了処理
+    glfwTerminate();
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,18 @@
+#version 120
+
+//
+// particle.frag
+//
+
+varying float alpha;
+
+void main(void)
+{
+    vec2 d = gl_PointCoord * 2.0 - 1.0;
+    float r = dot(d, d);
+    if (r > 1.0)
+    {
+        discard;
+    }
+    gl_FragColor = vec4(1.0, 0.6, 0.2, 1.0) * ((1.0 - r) * alpha * 0.3);
+}
\ No newline at end of file
@@ -0,0 +1,22 @@
+#version 120
+
+//
+// particle.vert
+//
+
+attribute float positionX;
+attribute float positionY;
+attribute float positionZ;
+attribute float life;
+
+uniform mat4 MVP;
+uniform float pointScale;
+
+varying float alpha;
+
+void main(void)
+{
+    gl_Position = MVP * vec4(positionX, positionY, positionZ, 1.0);
+    gl_PointSize = pointScale / gl_Position.w;
+    alpha = clamp(life, 0.0, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,21 @@
+#version 120
+
+//
+// particle_gpu.vert
+//
+
+attribute vec2 texCoord;
+
+uniform sampler2D positionTex;
+uniform mat4 MVP;
+uniform float pointScale;
+
+varying float alpha;
+
+void main(void)
+{
+    vec4 particle = texture2DLod(positionTex, texCoord, 0.0);
+    gl_Position = MVP * vec4(particle.xyz, 1.0);
+    gl_PointSize = pointScale / gl_Position.w;
+    alpha = clamp(particle.w, 0.0, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,49 @@
+#version 120
+
+//
+// simulate.frag
+//
+
+uniform sampler2D positionTex;
+uniform sampler2D velocityTex;
+uniform float dt;
+uniform float gravity;
+uniform float seed;
+uniform vec3 emitter;
+uniform float spread;
+
+varying vec2 texCoord;
+
+float random(vec2 co)
+{
+    return fract(sin(dot(co, vec2(12.9898, 78.233))) * 43758.5453);
+}
+
+void main(void)
+{
+    vec4 position = texture2D(positionTex, texCoord);
+    vec4 velocity = texture2D(velocityTex, texCoord);
+
+    velocity.z += gravity * dt;
+    position.xyz += velocity.xyz * dt;
+
+    if (position.z < 0.0)
+    {
+        position.z = -position.z;
+        velocity.z *= -0.5;
+    }
+
+    position.w -= dt;
+
+    if (position.w <= 0.0)
+    {
+        vec2 s = texCoord + vec2(seed, seed * 0.37);
+        vec3 r = vec3(random(s), random(s + 0.11), random(s + 0.23));
+        vec3 q = vec3(random(s + 0.31), random(s + 0.43), random(s + 0.57));
+        position = vec4(emitter + (r - 0.5) * vec3(spread, spread, 0.0), 1.0 + 2.0 * q.z);
+        velocity = vec4((q.x - 0.5) * 2.0, (q.y - 0.5) * 2.0, 3.0 + 2.0 * r.z, 0.0);
+    }
+
+    gl_FragData[0] = position;
+    gl_FragData[1] = velocity;
+}
\ No newline at end of file
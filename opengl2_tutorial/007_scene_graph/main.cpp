@@ -0,0 +1,726 @@
+#include "stdafx.h"
+#include <iostream>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <gl/glew.h>
+#include <GLFW/glfw3.h>
+
+// glmの使う機能をインクルード
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+//using namespace glm;でもいいけどここでは一部のみ「glm::」を省力できるようにする
+using glm::vec3;
+using glm::vec4;
+using glm::mat4;
+
+
+GLFWwindow* initGLFW(int width, int height)
+{
+    // GLFW初期化
+    if (glfwInit() == GL_FALSE)
+    {
+        return nullptr;
+    }
+
+    // ウィンドウ生成
+    GLFWwindow* window = glfwCreateWindow(width, height, "OpenGL Sample", NULL, NULL);
+    if (!window)
+    {
+        glfwTerminate();
+        return nullptr;
+    }
+
+    // バージョン2.1指定
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 2);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
+
+    glfwMakeContextCurrent(window);
+    glfwSwapInterval(0);
+
+    // GLEW初期化
+    if (glewInit() != GLEW_OK)
+    {
+        return nullptr;
+    }
+
+    return window;
+}
+
+GLint readShaderSource(GLuint shaderObj, std::string fileName)
+{
+    //ファイルの読み込み
+    std::ifstream ifs(fileName);
+    if (!ifs)
+    {
+        std::cout << "error" << std::endl;
+        return -1;
+    }
+
+    std::string source;
+    std::string line;
+    while (getline(ifs, line))
+    {
+        source += line + "\n";
+    }
+
+    // シェーダのソースプログラムをシェーダオブジェクトへ読み込む
+    const GLchar *sourcePtr = (const GLchar *)source.c_str();
+    GLint length = source.length();
+    glShaderSource(shaderObj, 1, &sourcePtr, &length);
+
+    return 0;
+}
+
+// シェーダーのコンパイルやリンクに失敗したときにログを表示する
+void printInfoLog(GLuint object, bool isProgram)
+{
+    GLint length = 0;
+    if (isProgram)
+    {
+        glGetProgramiv(object, GL_INFO_LOG_LENGTH, &length);
+    }
+    else
+    {
+        glGetShaderiv(object, GL_INFO_LOG_LENGTH, &length);
+    }
+    if (length <= 1)
+    {
+        return;
+    }
+    std::vector<GLchar> log(length);
+    if (isProgram)
+    {
+        glGetProgramInfoLog(object, length, NULL, &log[0]);
+    }
+    else
+    {
+        glGetShaderInfoLog(object, length, NULL, &log[0]);
+    }
+    fprintf(stderr, "%s\n", &log[0]);
+}
+
+
+// 失敗したときは作ったオブジェクトを全部削除して-1を返す
+GLint makeShader(std::string vertexFileName, std::string fragmentFileName)
+{
+    // シェーダーオブジェクト作成
+    GLuint vertShaderObj = glCreateShader(GL_VERTEX_SHADER);
+    GLuint fragShaderObj = glCreateShader(GL_FRAGMENT_SHADER);
+    GLuint shader;
+
+    // シェーダーコンパイルとリンクの結果用変数
+    GLint compiled, linked;
+
+    /* シェーダーのソースプログラムの読み込み */
+    if (readShaderSource(vertShaderObj, vertexFileName) || readShaderSource(fragShaderObj, fragmentFileName))
+    {
+        glDeleteShader(vertShaderObj);
+        glDeleteShader(fragShaderObj);
+        return -1;
+    }
+
+    /* バーテックスシェーダーのソースプログラムのコンパイル */
+    glCompileShader(vertShaderObj);
+    glGetShaderiv(vertShaderObj, GL_COMPILE_STATUS, &compiled);
+    if (compiled == GL_FALSE)
+    {
+        fprintf(stderr, "Compile error in vertex shader.\n");
+        printInfoLog(vertShaderObj, false);
+        glDeleteShader(vertShaderObj);
+        glDeleteShader(fragShaderObj);
+        return -1;
+    }
+
+    /* フラグメントシェーダーのソースプログラムのコンパイル */
+    glCompileShader(fragShaderObj);
+    glGetShaderiv(fragShaderObj, GL_COMPILE_STATUS, &compiled);
+    if (compiled == GL_FALSE)
+    {
+        fprintf(stderr, "Compile error in fragment shader.\n");
+        printInfoLog(fragShaderObj, false);
+        glDeleteShader(vertShaderObj);
+        glDeleteShader(fragShaderObj);
+        return -1;
+    }
+
+    /* プログラムオブジェクトの作成 */
+    shader = glCreateProgram();
+
+    /* シェーダーオブジェクトのシェーダープログラムへの登録 */
+    glAttachShader(shader, vertShaderObj);
+    glAttachShader(shader, fragShaderObj);
+
+    /* シェーダーオブジェクトの削除 */
+    glDeleteShader(vertShaderObj);
+    glDeleteShader(fragShaderObj);
+
+    /* シェーダープログラムのリンク */
+    glLinkProgram(shader);
+    glGetProgramiv(shader, GL_LINK_STATUS, &linked);
+    if (linked == GL_FALSE)
+    {
+        fprintf(stderr, "Link error.\n");
+        printInfoLog(shader, true);
+        glDeleteProgram(shader);
+        return -1;
+    }
+
+    return shader;
+}
+
+
+// ---------------------------------------------------------------------------
+// スレッドプール
+// parallelForで範囲をchunk単位に分け、ワーカーと呼び出し元のスレッドで処理する。
+// ---------------------------------------------------------------------------
+
+class ThreadPool
+{
+public:
+    typedef std::function<void(size_t begin, size_t end, size_t chunkIndex)> Job;
+
+    explicit ThreadPool(int threadCount)
+    {
+        // 呼び出し元のスレッドも働くのでワーカーは1つ少なくてよい
+        for (int i = 1; i < threadCount; ++i)
+        {
+            workers.push_back(std::thread(&ThreadPool::run, this));
+        }
+    }
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& worker : workers)
+        {
+            worker.join();
+        }
+    }
+
+    int threadCount() const
+    {
+        return workers.size() + 1;
+    }
+
+    // [0, count)を処理し終わるまで戻らない
+    void parallelFor(size_t count, size_t chunkSize, const Job& body)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            job = &body;
+            jobCount = count;
+            jobChunkSize = chunkSize;
+            nextChunk = 0;
+            activeWorkers = workers.size();
+            ++generation;
+        }
+        wake.notify_all();
+
+        work();
+
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this] { return activeWorkers == 0; });
+        job = nullptr;
+    }
+
+private:
+    void run()
+    {
+        size_t seenGeneration = 0;
+        for (;;)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&] { return stopping || generation != seenGeneration; });
+                if (stopping)
+                {
+                    return;
+                }
+                seenGeneration = generation;
+            }
+
+            work();
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--activeWorkers == 0)
+            {
+                done.notify_one();
+            }
+        }
+    }
+
+    void work()
+    {
+        for (;;)
+        {
+            size_t chunkIndex = nextChunk.fetch_add(1);
+            size_t begin = chunkIndex * jobChunkSize;
+            if (begin >= jobCount)
+            {
+                return;
+            }
+            (*job)(begin, std::min(begin + jobChunkSize, jobCount), chunkIndex);
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    const Job* job = nullptr;
+    size_t jobCount = 0;
+    size_t jobChunkSize = 1;
+    std::atomic<size_t> nextChunk;
+    size_t generation = 0;
+    int activeWorkers = 0;
+    bool stopping = false;
+};
+
+
+// ---------------------------------------------------------------------------
+// シーングラフ
+// ノードは親が必ず子より前に来る順番(深さ優先の前順)で1つの配列に並べる。
+// この順番だと、あるノードのサブツリーは[i, subtreeEnd[i])の連続した範囲になるので
+// 配列を先頭から1回なめるだけでワールド行列を親から子へ伝えられ、
+// 独立したサブツリーごとに別スレッドへ渡すこともできる。
+//
+// setLocalされたノードにはlocalDirty、そこから根までのノードにはsubtreeDirtyを立てる。
+// updateではsubtreeDirtyの立っていないサブツリーは丸ごと飛ばし、変更のあった部分だけ計算する。
+// ---------------------------------------------------------------------------
+
+class SceneGraph
+{
+public:
+    // parents[i]はノードiの親の番号(親が無ければ-1)。親は子より小さい番号であること
+    SceneGraph(const std::vector<int>& parents, const std::vector<mat4>& locals)
+    {
+        int count = parents.size();
+
+        // 子の一覧を作ってから深さ優先で並べ直す
+        std::vector<std::vector<int>> children(count);
+        std::vector<int> roots;
+        for (int i = 0; i < count; ++i)
+        {
+            if (parents[i] < 0)
+            {
+                roots.push_back(i);
+            }
+            else
+            {
+                children[parents[i]].push_back(i);
+            }
+        }
+
+        handleToIndex.resize(count);
+        parent.resize(count);
+        depth.resize(count);
+        subtreeEnd.resize(count);
+        local.resize(count);
+        world.resize(count);
+        localDirty.assign(count, 1);
+        subtreeDirty.assign(count, 1);
+        worldChanged.assign(count, 0);
+
+        // 再帰だと深い階層でスタックが溢れるので明示的なスタックを使う
+        int next = 0;
+        std::vector<std::pair<int, int>> stack;  // (元の番号, 新しい親の番号)
+        for (auto it = roots.rbegin(); it != roots.rend(); ++it)
+        {
+            stack.push_back(std::make_pair(*it, -1));
+        }
+        std::vector<int> visitOrder;
+        visitOrder.reserve(count);
+        while (!stack.empty())
+        {
+            int handle = stack.back().first;
+            int parentIndex = stack.back().second;
+            stack.pop_back();
+
+            int index = next++;
+            handleToIndex[handle] = index;
+            visitOrder.push_back(handle);
+            parent[index] = parentIndex;
+            depth[index] = parentIndex < 0 ? 0 : depth[parentIndex] + 1;
+            local[index] = locals[handle];
+
+            for (auto it = children[handle].rbegin(); it != children[handle].rend(); ++it)
+            {
+                stack.push_back(std::make_pair(*it, index));
+            }
+        }
+
+        // 後ろから見ていけば子のsubtreeEndが先に決まる
+        for (int i = count - 1; i >= 0; --i)
+        {
+            int end = i + 1;
+            for (int child : children[visitOrder[i]])
+            {
+                end = std::max(end, subtreeEnd[handleToIndex[child]]);
+            }
+            subtreeEnd[i] = end;
+        }
+    }
+
+    int size() const
+    {
+        return parent.size();
+    }
+
+    // 元の番号から配列上の番号へ
+    int indexOf(int handle) const
+    {
+        return handleToIndex[handle];
+    }
+
+    void setLocal(int index, const mat4& matrix)
+    {
+        local[index] = matrix;
+        localDirty[index] = 1;
+        // 根に向かってsubtreeDirtyを立てる。既に立っていればその先も立っている
+        for (int n = index; n >= 0 && !subtreeDirty[n]; n = parent[n])
+        {
+            subtreeDirty[n] = 1;
+        }
+    }
+
+    const mat4& worldMatrix(int index) const
+    {
+        return world[index];
+    }
+
+    // 比較用: 全ノードのワールド行列を毎回計算し直す
+    int updateAll()
+    {
+        int count = size();
+        for (int i = 0; i < count; ++i)
+        {
+            world[i] = parent[i] < 0 ? local[i] : world[parent[i]] * local[i];
+        }
+        std::fill(localDirty.begin(), localDirty.end(), 0);
+        std::fill(subtreeDirty.begin(), subtreeDirty.end(), 0);
+        return count;
+    }
+
+    // 変更のあったサブツリーだけ計算し直す。戻り値は計算し直したノード数
+    // splitDepthより浅いノードは呼び出し元のスレッドで処理し、
+    // splitDepthの深さにあるノードのサブツリーをスレッドプールで分担する
+    int update(ThreadPool& pool, int splitDepth)
+    {
+        std::vector<int>& tasks = taskRoots;
+        tasks.clear();
+
+        int count = size();
+        int recomputed = 0;
+        for (int i = 0; i < count;)
+        {
+            if (depth[i] == splitDepth)
+            {
+                if (subtreeDirty[i] || parentChanged(i))
+                {
+                    tasks.push_back(i);
+                }
+                i = subtreeEnd[i];
+                continue;
+            }
+            i = visit(i, recomputed);
+        }
+
+        std::atomic<int> parallelRecomputed(0);
+        pool.parallelFor(tasks.size(), 1, [&](size_t begin, size_t end, size_t) {
+            for (size_t t = begin; t < end; ++t)
+            {
+                int root = tasks[t];
+                int n = 0;
+                for (int i = root; i < subtreeEnd[root];)
+                {
+                    i = visit(i, n);
+                }
+                parallelRecomputed += n;
+            }
+        });
+
+        return recomputed + parallelRecomputed;
+    }
+
+    // ノード数がthreadCount * 8以上になる最初の深さ(サブツリーの分割点)
+    int chooseSplitDepth(int threadCount) const
+    {
+        std::vector<int> nodesPerDepth;
+        for (int d : depth)
+        {
+            if (d >= (int)nodesPerDepth.size())
+            {
+                nodesPerDepth.resize(d + 1, 0);
+            }
+            ++nodesPerDepth[d];
+        }
+        for (size_t d = 0; d < nodesPerDepth.size(); ++d)
+        {
+            if (nodesPerDepth[d] >= threadCount * 8)
+            {
+                return d;
+            }
+        }
+        return 0;
+    }
+
+private:
+    bool parentChanged(int index) const
+    {
+        return parent[index] >= 0 && worldChanged[parent[index]];
+    }
+
+    // ノードを1つ処理して次に見るノードの番号を返す
+    int visit(int index, int& recomputed)
+    {
+        bool changed = localDirty[index] || parentChanged(index);
+        if (!changed && !subtreeDirty[index])
+        {
+            // このサブツリーには何も変更が無い
+            worldChanged[index] = 0;
+            return subtreeEnd[index];
+        }
+
+        if (changed)
+        {
+            world[index] = parent[index] < 0 ? local[index] : world[parent[index]] * local[index];
+            ++recomputed;
+        }
+        worldChanged[index] = changed;
+        localDirty[index] = 0;
+        subtreeDirty[index] = 0;
+        return index + 1;
+    }
+
+    std::vector<int> handleToIndex;
+    std::vector<int> parent;
+    std::vector<int> depth;
+    std::vector<int> subtreeEnd;
+    std::vector<mat4> local;
+    std::vector<mat4> world;
+    std::vector<uint8_t> localDirty;    // ローカル行列が変更された
+    std::vector<uint8_t> subtreeDirty;  // 自分か子孫のどれかが変更された
+    std::vector<uint8_t> worldChanged;  // 今回のupdateでワールド行列が変わった
+    std::vector<int> taskRoots;
+};
+
+
+// ---------------------------------------------------------------------------
+// テスト用の階層を作る
+// 根をいくつか作り、それ以降のノードは平均4つの子を持つ木にする(10万ノードで深さ8程度)
+// ---------------------------------------------------------------------------
+
+uint32_t nextRandom(uint32_t& state)
+{
+    state ^= state << 13; state ^= state >> 17; state ^= state << 5;
+    return state;
+}
+
+float randomFloat(uint32_t& state)
+{
+    return (nextRandom(state) >> 8) / (float)(1 << 24);
+}
+
+void makeHierarchy(int nodeCount, int rootCount, std::vector<int>& parents, std::vector<mat4>& locals)
+{
+    uint32_t rng = 2463534242u;
+    parents.resize(nodeCount);
+    locals.resize(nodeCount);
+    for (int i = 0; i < nodeCount; ++i)
+    {
+        if (i < rootCount)
+        {
+            parents[i] = -1;
+            float angle = 6.2831853f * i / rootCount;
+            locals[i] = glm::translate(mat4(1.0f), vec3(std::cos(angle), std::sin(angle), 0.0f) * 8.0f);
+        }
+        else
+        {
+            // 親の候補を少しずらして子の数をばらつかせる
+            int parentIndex = (i - rootCount) / 4 + (int)(nextRandom(rng) % 3) - 1;
+            parents[i] = std::max(0, std::min(parentIndex, i - 1));
+            vec3 offset(randomFloat(rng) - 0.5f, randomFloat(rng) - 0.5f, randomFloat(rng) * 0.5f);
+            locals[i] = glm::rotate(glm::translate(mat4(1.0f), offset), randomFloat(rng), vec3(0.0f, 0.0f, 1.0f));
+        }
+    }
+}
+
+
+// 使い方: 007_scene_graph [ノード数] [毎フレーム動かす割合] [計測フレーム数]
+int main(int argc, char* argv[])
+{
+    GLint width = 640, height = 480;
+    int nodeCount = argc > 1 ? atoi(argv[1]) : 100000;
+    float movingFraction = argc > 2 ? (float)atof(argv[2]) : 0.01f;
+    int benchFrames = argc > 3 ? atoi(argv[3]) : 200;
+    const int rootCount = 64;
+    // 1フレームに描くノード数の上限(ドローコールが多すぎると描画がボトルネックになる)
+    const int drawLimit = 5000;
+
+    // ノード数が0以下だと動かすノードを選ぶときに0で割ってしまう
+    if (nodeCount <= 0 || benchFrames <= 0 || !(movingFraction > 0.0f && movingFraction <= 1.0f))
+    {
+        fprintf(stderr, "Node count and bench frames must be positive, and the moving fraction must be in (0, 1].\n");
+        return -1;
+    }
+
+    GLFWwindow* window = initGLFW(width, height);
+
+    std::vector<int> parents;
+    std::vector<mat4> baseLocals;
+    makeHierarchy(nodeCount, rootCount, parents, baseLocals);
+
+    ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()));
+    ThreadPool serialPool(1);
+    SceneGraph scene(parents, baseLocals);
+    int splitDepth = scene.chooseSplitDepth(pool.threadCount());
+    int movingCount = std::max(1, (int)(nodeCount * movingFraction));
+
+    // 毎フレームランダムに選んだノードを回す
+    uint32_t moveRng = 88675123u;
+    auto moveNodes = [&](float time) {
+        for (int m = 0; m < movingCount; ++m)
+        {
+            int handle = nextRandom(moveRng) % nodeCount;
+            mat4 spin = glm::rotate(mat4(1.0f), time, vec3(0.0f, 0.0f, 1.0f));
+            scene.setLocal(scene.indexOf(handle), baseLocals[handle] * spin);
+        }
+    };
+
+    // ベンチマーク: 全再計算 / ダーティフラグ(1スレッド) / ダーティフラグ(並列)
+    scene.updateAll();
+    const char* names[3] = { "full recompute", "dirty flags, 1 thread", "dirty flags, parallel" };
+    double seconds[3] = { 0.0, 0.0, 0.0 };
+    long long recomputed[3] = { 0, 0, 0 };
+    for (int mode = 0; mode < 3; ++mode)
+    {
+        for (int frame = 0; frame < benchFrames; ++frame)
+        {
+            moveNodes(frame * 0.01f);
+            double start = glfwGetTime();
+            switch (mode)
+            {
+            case 0: recomputed[mode] += scene.updateAll(); break;
+            case 1: recomputed[mode] += scene.update(serialPool, splitDepth); break;
+            case 2: recomputed[mode] += scene.update(pool, splitDepth); break;
+            }
+            seconds[mode] += glfwGetTime() - start;
+        }
+    }
+    printf("%d nodes, %d moving per frame (%.2f%%), %d threads, split depth %d\n",
+        nodeCount, movingCount, movingFraction * 100.0f, pool.threadCount(), splitDepth);
+    for (int mode = 0; mode < 3; ++mode)
+    {
+        printf("  %-22s %8.3f ms/frame  %10.0f nodes recomputed/frame\n",
+            names[mode], seconds[mode] * 1000.0 / benchFrames, (double)recomputed[mode] / benchFrames);
+    }
+
+    GLint shader = makeShader("shader.vert", "shader.frag");
+
+    // ノード1つを小さな三角錐で表す
+    std::vector<vec3> positions = {
+        vec3( 0, 0, 1),vec3(-1,-1, 0),vec3( 1, 0, 0),
+        vec3( 0, 0, 1),vec3( 1, 0, 0),vec3( 0, 1, 0),
+        vec3( 0, 0, 1),vec3( 0, 1, 0),vec3(-1,-1, 0),
+        vec3(-1,-1, 0),vec3( 0, 1, 0),vec3( 1, 0, 0),
+    };
+    for (vec3& p : positions)
+    {
+        p *= 0.1f;
+    }
+    std::vector<vec4> colors;
+    vec4 faceColor[4] = { vec4(1,0,0,1), vec4(0,1,0,1), vec4(0,0,1,1), vec4(1,1,0,1) };
+    for (int i = 0; i < 4; ++i)
+    {
+        colors.insert(colors.end(), 3, faceColor[i]);
+    }
+
+    GLint positionLocation = glGetAttribLocation(shader, "position");
+    GLint colorLocation = glGetAttribLocation(shader, "color");
+    GLuint buffers[2];
+    glGenBuffers(2, &buffers[0]);
+    glBindBuffer(GL_ARRAY_BUFFER, buffers[0]);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vec3) * positions.size(), &positions[0], GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, buffers[1]);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vec4) * colors.size(), &colors[0], GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    GLuint matrixID = glGetUniformLocation(shader, "MVP");
+    int drawStride = std::max(1, nodeCount / drawLimit);
+
+    // フレームループ
+    while (glfwWindowShouldClose(window) == GL_FALSE)
+    {
+        moveNodes((float)glfwGetTime());
+        scene.update(pool, splitDepth);
+
+        glUseProgram(shader);
+
+        glEnable(GL_DEPTH_TEST);
+        glDepthFunc(GL_LESS);
+        glClearColor(0.2f, 0.2f, 0.2f, 0.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        // View行列を計算
+        mat4 viewMat = glm::lookAt(
+            vec3(20.0, 20.0, 20.0), // ワールド空間でのカメラの座標
+            vec3(0.0, 0.0, 0.0), // 見ている位置の座標
+            vec3(0.0, 0.0, 1.0)  // 上方向を示す。(0,1.0,0)に設定するとy軸が上になります
+        );
+
+        // Projection行列を計算
+        mat4 projectionMat = glm::perspective(
+            glm::radians(45.0f), // ズームの度合い(通常90～30)
+            (GLfloat)width / (GLfloat)height,		// アスペクト比
+            0.1f,		// 近くのクリッピング平面
+            200.0f		// 遠くのクリッピング平面
+        );
+        mat4 viewProjectionMat = projectionMat * viewMat;
+
+        glEnableVertexAttribArray(positionLocation);
+        glBindBuffer(GL_ARRAY_BUFFER, buffers[0]);
+        glVertexAttribPointer(positionLocation, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
+        glEnableVertexAttribArray(colorLocation);
+        glBindBuffer(GL_ARRAY_BUFFER, buffers[1]);
+        glVertexAttribPointer(colorLocation, 4, GL_FLOAT, GL_FALSE, 0, (void*)0);
+
+        // シーングラフのワールド行列をそのままModel行列として使う
+        for (int i = 0; i < scene.size(); i += drawStride)
+        {
+            mat4 mvpMat = viewProjectionMat * scene.worldMatrix(i);
+            glUniformMatrix4fv(matrixID, 1, GL_FALSE, &mvpMat[0][0]);
+            glDrawArrays(GL_TRIANGLES, 0, positions.size());
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        // ダブルバッファのスワップ
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+    }
+
+    glDeleteBuffers(2, &buffers[0]);
+    glDeleteProgram(shader);
+
+    // GLFWの終了処理
+    glfwTerminate();
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,660 @@
+#include "stdafx.h"
+#include <iostream>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <utility>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <gl/glew.h>
+#include <GLFW/glfw3.h>
+
+#ifdef _WIN32
+// スリープの分解能を上げるためにtimeBeginPeriodを使う
+#define NOMINMAX
+#include <windows.h>
+#pragma comment(lib, "winmm.lib")
+#endif
+
+// glmの使う機能をインクルード
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+//using namespace glm;でもいいけどここでは一部のみ「glm::」を省力できるようにする
+using glm::vec2;
+using glm::vec3;
+using glm::vec4;
+using glm::mat4;
+
+
+GLFWwindow* initGLFW(int width, int height, int swapInterval)
+{
+    // GLFW初期化
+    if (glfwInit() == GL_FALSE)
+    {
+        return nullptr;
+    }
+
+    // ウィンドウ生成
+    GLFWwindow* window = glfwCreateWindow(width, height, "OpenGL Sample", NULL, NULL);
+    if (!window)
+    {
+        glfwTerminate();
+        return nullptr;
+    }
+
+    // バージョン2.1指定
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 2);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
+
+    glfwMakeContextCurrent(window);
+    // 0: 垂直同期なし(フレームペーサーだけで待つ) 1: 垂直同期あり
+    glfwSwapInterval(swapInterval);
+
+    // GLEW初期化
+    if (glewInit() != GLEW_OK)
+    {
+        return nullptr;
+    }
+
+    return window;
+}
+
+GLint readShaderSource(GLuint shaderObj, std::string fileName)
+{
+    //ファイルの読み込み
+    std::ifstream ifs(fileName);
+    if (!ifs)
+    {
+        std::cout << "error" << std::endl;
+        return -1;
+    }
+
+    std::string source;
+    std::string line;
+    while (getline(ifs, line))
+    {
+        source += line + "\n";
+    }
+
+    // シェーダのソースプログラムをシェーダオブジェクトへ読み込む
+    const GLchar *sourcePtr = (const GLchar *)source.c_str();
+    GLint length = source.length();
+    glShaderSource(shaderObj, 1, &sourcePtr, &length);
+
+    return 0;
+}
+
+// シェーダーのコンパイルやリンクに失敗したときにログを表示する
+void printInfoLog(GLuint object, bool isProgram)
+{
+    GLint length = 0;
+    if (isProgram)
+    {
+        glGetProgramiv(object, GL_INFO_LOG_LENGTH, &length);
+    }
+    else
+    {
+        glGetShaderiv(object, GL_INFO_LOG_LENGTH, &length);
+    }
+    if (length <= 1)
+    {
+        return;
+    }
+    std::vector<GLchar> log(length);
+    if (isProgram)
+    {
+        glGetProgramInfoLog(object, length, NULL, &log[0]);
+    }
+    else
+    {
+        glGetShaderInfoLog(object, length, NULL, &log[0]);
+    }
+    fprintf(stderr, "%s\n", &log[0]);
+}
+
+
+// 失敗したときは作ったオブジェクトを全部削除して-1を返す
+GLint makeShader(std::string vertexFileName, std::string fragmentFileName)
+{
+    // シェーダーオブジェクト作成
+    GLuint vertShaderObj = glCreateShader(GL_VERTEX_SHADER);
+    GLuint fragShaderObj = glCreateShader(GL_FRAGMENT_SHADER);
+    GLuint shader;
+
+    // シェーダーコンパイルとリンクの結果用変数
+    GLint compiled, linked;
+
+    /* シェーダーのソースプログラムの読み込み */
+    if (readShaderSource(vertShaderObj, vertexFileName) || readShaderSource(fragShaderObj, fragmentFileName))
+    {
+        glDeleteShader(vertShaderObj);
+        glDeleteShader(fragShaderObj);
+        return -1;
+    }
+
+    /* バーテックスシェーダーのソースプログラムのコンパイル */
+    glCompileShader(vertShaderObj);
+    glGetShaderiv(vertShaderObj, GL_COMPILE_STATUS, &compiled);
+    if (compiled == GL_FALSE)
+    {
+        fprintf(stderr, "Compile error in vertex shader.\n");
+        printInfoLog(vertShaderObj, false);
+        glDeleteShader(vertShaderObj);
+        glDeleteShader(fragShaderObj);
+        return -1;
+    }
+
+    /* フラグメントシェーダーのソースプログラムのコンパイル */
+    glCompileShader(fragShaderObj);
+    glGetShaderiv(fragShaderObj, GL_COMPILE_STATUS, &compiled);
+    if (compiled == GL_FALSE)
+    {
+        fprintf(stderr, "Compile error in fragment shader.\n");
+        printInfoLog(fragShaderObj, false);
+        glDeleteShader(vertShaderObj);
+        glDeleteShader(fragShaderObj);
+        return -1;
+    }
+
+    /* プログラムオブジェクトの作成 */
+    shader = glCreateProgram();
+
+    /* シェーダーオブジェクトのシェーダープログラムへの登録 */
+    glAttachShader(shader, vertShaderObj);
+    glAttachShader(shader, fragShaderObj);
+
+    /* シェーダーオブジェクトの削除 */
+    glDeleteShader(vertShaderObj);
+    glDeleteShader(fragShaderObj);
+
+    /* シェーダープログラムのリンク */
+    glLinkProgram(shader);
+    glGetProgramiv(shader, GL_LINK_STATUS, &linked);
+    if (linked == GL_FALSE)
+    {
+        fprintf(stderr, "Link error.\n");
+        printInfoLog(shader, true);
+        glDeleteProgram(shader);
+        return -1;
+    }
+
+    return shader;
+}
+
+
+// ---------------------------------------------------------------------------
+// フレームペーシング
+// 目標のフレーム時間ごとに次のフレームを始める。
+// 締め切りの少し前まではスリープし(CPUを使わない)、残りはスピンで待つ(スリープの誤差を避ける)。
+// ---------------------------------------------------------------------------
+
+class FramePacer
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    FramePacer(double targetSeconds, double spinSeconds)
+        : target(toDuration(targetSeconds)), spin(toDuration(spinSeconds))
+    {
+        nextFrame = Clock::now() + target;
+    }
+
+    double targetSeconds() const
+    {
+        return std::chrono::duration<double>(target).count();
+    }
+
+    // 次のフレームの開始時刻まで待つ
+    void wait()
+    {
+        Clock::time_point now = Clock::now();
+        if (nextFrame - now > spin)
+        {
+            std::this_thread::sleep_for(nextFrame - now - spin);
+        }
+        while (Clock::now() < nextFrame)
+        {
+        }
+
+        nextFrame += target;
+        // 1フレーム以上遅れていたら追いつこうとせずに基準をずらす
+        now = Clock::now();
+        if (now > nextFrame)
+        {
+            nextFrame = now + target;
+        }
+    }
+
+private:
+    static Clock::duration toDuration(double seconds)
+    {
+        return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+    }
+
+    Clock::duration target;
+    Clock::duration spin;
+    Clock::time_point nextFrame;
+};
+
+
+// ---------------------------------------------------------------------------
+// 解像度スケールの調整
+// フレームコストの移動平均が予算を超えたら縮小率を下げ、十分余裕があれば上げる。
+// ピクセル数は縮小率の2乗に比例するので、目標コストとの比の平方根で次の縮小率を決める。
+// ---------------------------------------------------------------------------
+
+class ResolutionScaler
+{
+public:
+    ResolutionScaler(double budgetSeconds, float minScale)
+        : budget(budgetSeconds), minScale(minScale)
+    {
+        history.push_back(std::make_pair(0, currentScale));
+    }
+
+    float scale() const
+    {
+        return currentScale;
+    }
+
+    // 今フレームのコストを渡す。縮小率が変わったらtrue
+    bool update(double costSeconds, int frame)
+    {
+        averageCost = averageCost == 0.0 ? costSeconds : averageCost * 0.9 + costSeconds * 0.1;
+
+        // 変更直後は移動平均が落ち着くまで待つ
+        if (cooldown > 0)
+        {
+            --cooldown;
+            return false;
+        }
+
+        bool overBudget = averageCost > budget * 0.95;
+        bool underBudget = averageCost < budget * 0.7;
+        if (!(overBudget && currentScale > minScale) && !(underBudget && currentScale < 1.0f))
+        {
+            return false;
+        }
+
+        float desired = currentScale * (float)std::sqrt(budget * 0.85 / averageCost);
+        // 一度に大きく変えすぎない。上げるときはゆっくり
+        desired = std::min(desired, currentScale + 0.05f);
+        desired = std::max(desired, currentScale - 0.15f);
+        // 細かく揺れないように1/20刻みにする
+        desired = std::floor(desired * 20.0f + 0.5f) / 20.0f;
+        desired = std::max(minScale, std::min(1.0f, desired));
+        if (desired == currentScale)
+        {
+            return false;
+        }
+
+        // 縮小率が変わればコストも変わるので、比率に合わせて移動平均を補正しておく
+        averageCost *= (desired * desired) / (currentScale * currentScale);
+        currentScale = desired;
+        cooldown = 15;
+        history.push_back(std::make_pair(frame, currentScale));
+        return true;
+    }
+
+    // (フレーム番号, 縮小率)の変更履歴
+    std::vector<std::pair<int, float>> history;
+
+private:
+    double budget;
+    float minScale;
+    float currentScale = 1.0f;
+    double averageCost = 0.0;
+    int cooldown = 0;
+};
+
+
+// ---------------------------------------------------------------------------
+// 縮小描画用のオフスクリーンターゲット
+// ウィンドウと同じ大きさのテクスチャを作っておき、縮小率に応じてその一部だけに描く。
+// 表示するときに全画面の四角形で引き伸ばす。
+// ---------------------------------------------------------------------------
+
+class ScaledRenderTarget
+{
+public:
+    ScaledRenderTarget(int width, int height)
+        : width(width), height(height)
+    {
+        glGenTextures(1, &colorTexture);
+        glBindTexture(GL_TEXTURE_2D, colorTexture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        glGenRenderbuffersEXT(1, &depthBuffer);
+        glBindRenderbufferEXT(GL_RENDERBUFFER_EXT, depthBuffer);
+        glRenderbufferStorageEXT(GL_RENDERBUFFER_EXT, GL_DEPTH_COMPONENT24, width, height);
+        glBindRenderbufferEXT(GL_RENDERBUFFER_EXT, 0);
+
+        glGenFramebuffersEXT(1, &fbo);
+        glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, fbo);
+        glFramebufferTexture2DEXT(GL_FRAMEBUFFER_EXT, GL_COLOR_ATTACHMENT0_EXT, GL_TEXTURE_2D, colorTexture, 0);
+        glFramebufferRenderbufferEXT(GL_FRAMEBUFFER_EXT, GL_DEPTH_ATTACHMENT_EXT, GL_RENDERBUFFER_EXT, depthBuffer);
+        valid = glCheckFramebufferStatusEXT(GL_FRAMEBUFFER_EXT) == GL_FRAMEBUFFER_COMPLETE_EXT;
+        glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, 0);
+
+        presentShader = makeShader("present.vert", "present.frag");
+        valid = valid && presentShader > 0;
+
+        vec2 quad[4] = { vec2(-1, -1), vec2(1, -1), vec2(-1, 1), vec2(1, 1) };
+        glGenBuffers(1, &quadBuffer);
+        glBindBuffer(GL_ARRAY_BUFFER, quadBuffer);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    ~ScaledRenderTarget()
+    {
+        glDeleteBuffers(1, &quadBuffer);
+        glDeleteFramebuffersEXT(1, &fbo);
+        glDeleteRenderbuffersEXT(1, &depthBuffer);
+        glDeleteTextures(1, &colorTexture);
+        if (presentShader > 0) glDeleteProgram(presentShader);
+    }
+
+    bool isValid() const
+    {
+        return valid;
+    }
+
+    // 縮小した大きさのビューポートでオフスクリーンに描き始める
+    void begin(float scale)
+    {
+        scaledWidth = std::max(1, (int)(width * scale));
+        scaledHeight = std::max(1, (int)(height * scale));
+        glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, fbo);
+        glViewport(0, 0, scaledWidth, scaledHeight);
+    }
+
+    // 描いた範囲をウィンドウ全体に引き伸ばす
+    void present()
+    {
+        glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, 0);
+        glViewport(0, 0, width, height);
+        glDisable(GL_DEPTH_TEST);
+
+        glUseProgram(presentShader);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, colorTexture);
+        glUniform1i(glGetUniformLocation(presentShader, "colorTex"), 0);
+        glUniform2f(glGetUniformLocation(presentShader, "uvScale"),
+            (GLfloat)scaledWidth / width, (GLfloat)scaledHeight / height);
+
+        GLint positionLocation = glGetAttribLocation(presentShader, "position");
+        glBindBuffer(GL_ARRAY_BUFFER, quadBuffer);
+        glEnableVertexAttribArray(positionLocation);
+        glVertexAttribPointer(positionLocation, 2, GL_FLOAT, GL_FALSE, 0, (void*)0);
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        glDisableVertexAttribArray(positionLocation);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+private:
+    int width, height;
+    int scaledWidth = 0, scaledHeight = 0;
+    GLuint colorTexture, depthBuffer, fbo, quadBuffer;
+    GLint presentShader;
+    bool valid;
+};
+
+
+// フレーム時間の統計(平均と分散を逐次計算する)
+struct FrameStats
+{
+    int count = 0;
+    double mean = 0.0;
+    double m2 = 0.0;
+    double minValue = 1e30;
+    double maxValue = 0.0;
+    int overBudget = 0;
+
+    void add(double value, double budget)
+    {
+        ++count;
+        double delta = value - mean;
+        mean += delta / count;
+        m2 += delta * (value - mean);
+        minValue = std::min(minValue, value);
+        maxValue = std::max(maxValue, value);
+        if (value > budget * 1.05)
+        {
+            ++overBudget;
+        }
+    }
+
+    double variance() const
+    {
+        return count > 1 ? m2 / (count - 1) : 0.0;
+    }
+
+    void print(const char* name) const
+    {
+        printf("  %-12s mean %7.3f ms  stddev %7.3f ms  variance %9.4f ms^2  min %7.3f ms  max %7.3f ms  over budget %d/%d\n",
+            name, mean * 1000.0, std::sqrt(variance()) * 1000.0, variance() * 1e6,
+            minValue * 1000.0, maxValue * 1000.0, overBudget, count);
+    }
+};
+
+
+// 使い方: 008_frame_pacing [目標fps] [swapInterval] [負荷(シェーダーのループ回数)] [幅] [高さ]
+int main(int argc, char* argv[])
+{
+    double targetFps = argc > 1 ? atof(argv[1]) : 60.0;
+    int swapInterval = argc > 2 ? atoi(argv[2]) : 0;
+    int iterations = argc > 3 ? atoi(argv[3]) : 64;
+    GLint width = argc > 4 ? atoi(argv[4]) : 640;
+    GLint height = argc > 5 ? atoi(argv[5]) : 480;
+
+    // 極端な値だと1フレームの時間がClock::durationに収まらなくなるので範囲を決めておく
+    if (!(targetFps >= 1.0 && targetFps <= 1000.0))
+    {
+        fprintf(stderr, "Target fps must be in [1, 1000]: %s\n", argv[1]);
+        return -1;
+    }
+    if (width <= 0 || height <= 0)
+    {
+        fprintf(stderr, "Window size must be positive.\n");
+        return -1;
+    }
+
+    GLFWwindow* window = initGLFW(width, height, swapInterval);
+    if (!window)
+    {
+        fprintf(stderr, "Failed to create a %dx%d window.\n", width, height);
+        return -1;
+    }
+
+#ifdef _WIN32
+    // 既定の約15.6msではスリープが粗すぎるので1msにする
+    timeBeginPeriod(1);
+#endif
+
+    GLint shader = makeShader("shader.vert", "shader.frag");
+
+    // 4枚のポリゴンから成る三角錐と床
+    std::vector<vec3> positions = {
+        vec3( 0, 0, 1),vec3(-1,-1, 0),vec3( 1, 0, 0),
+        vec3( 0, 0, 1),vec3( 1, 0, 0),vec3( 0, 1, 0),
+        vec3( 0, 0, 1),vec3( 0, 1, 0),vec3(-1,-1, 0),
+        vec3(-1,-1, 0),vec3( 0, 1, 0),vec3( 1, 0, 0),
+        vec3(-4.0f,-4.0f,-0.01f),vec3( 4.0f,-4.0f,-0.01f),vec3( 4.0f, 4.0f,-0.01f),
+        vec3(-4.0f,-4.0f,-0.01f),vec3( 4.0f, 4.0f,-0.01f),vec3(-4.0f, 4.0f,-0.01f),
+    };
+    std::vector<vec4> colors;
+    vec4 faceColor[5] = { vec4(1,0,0,1), vec4(0,1,0,1), vec4(0,0,1,1), vec4(1,1,0,1), vec4(0.5f,0.5f,0.5f,1) };
+    for (int i = 0; i < 6; ++i)
+    {
+        colors.insert(colors.end(), 3, faceColor[std::min(i, 4)]);
+    }
+
+    GLint positionLocation = glGetAttribLocation(shader, "position");
+    GLint colorLocation = glGetAttribLocation(shader, "color");
+    GLuint buffers[2];
+    glGenBuffers(2, &buffers[0]);
+    glBindBuffer(GL_ARRAY_BUFFER, buffers[0]);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vec3) * positions.size(), &positions[0], GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, buffers[1]);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vec4) * colors.size(), &colors[0], GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    GLuint matrixID = glGetUniformLocation(shader, "MVP");
+    GLuint iterationsID = glGetUniformLocation(shader, "iterations");
+
+    // FBOはglfwTerminateの前に削除したいのでスコープを切る
+    {
+        double budget = 1.0 / targetFps;
+        // スリープの誤差を見込んで、最後の2msはスピンで待つ
+        FramePacer pacer(budget, 0.002);
+        ResolutionScaler scaler(budget, 0.5f);
+
+        ScaledRenderTarget* scaledTarget = nullptr;
+        if (GLEW_EXT_framebuffer_object)
+        {
+            scaledTarget = new ScaledRenderTarget(width, height);
+            if (!scaledTarget->isValid())
+            {
+                delete scaledTarget;
+                scaledTarget = nullptr;
+            }
+        }
+        if (!scaledTarget)
+        {
+            printf("Framebuffer objects are not available; adaptive resolution is disabled.\n");
+        }
+
+        FrameStats frameTimes, frameCosts;
+        int frame = 0;
+        double lastFrameStart = glfwGetTime();
+
+        // フレームループ
+        while (glfwWindowShouldClose(window) == GL_FALSE)
+        {
+            double frameStart = glfwGetTime();
+            if (frame > 0)
+            {
+                frameTimes.add(frameStart - lastFrameStart, budget);
+            }
+            lastFrameStart = frameStart;
+
+            // 予算内に収まっている間は直接バックバッファへ、超えたら縮小したオフスクリーンへ描く
+            bool scaled = scaledTarget && scaler.scale() < 1.0f;
+            if (scaled)
+            {
+                scaledTarget->begin(scaler.scale());
+            }
+            else
+            {
+                glViewport(0, 0, width, height);
+            }
+
+            glUseProgram(shader);
+            glUniform1i(iterationsID, iterations);
+
+            glEnable(GL_DEPTH_TEST);
+            glDepthFunc(GL_LESS);
+            glClearColor(0.2f, 0.2f, 0.2f, 0.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            mat4 modelMat = glm::rotate(mat4(1.0f), (float)frameStart, vec3(0.0f, 0.0f, 1.0f));
+
+            // View行列を計算
+            mat4 viewMat = glm::lookAt(
+                vec3(1.0, 2.0, 6.0), // ワールド空間でのカメラの座標
+                vec3(0.0, 0.0, 0.0), // 見ている位置の座標
+                vec3(0.0, 0.0, 1.0)  // 上方向を示す。(0,1.0,0)に設定するとy軸が上になります
+            );
+
+            // Projection行列を計算
+            mat4 projectionMat = glm::perspective(
+                glm::radians(45.0f), // ズームの度合い(通常90～30)
+                (GLfloat)width / (GLfloat)height,		// アスペクト比
+                0.1f,		// 近くのクリッピング平面
+                100.0f		// 遠くのクリッピング平面
+            );
+
+            // ModelViewProjection行列を計算
+            mat4 mvpMat = projectionMat * viewMat* modelMat;
+            glUniformMatrix4fv(matrixID, 1, GL_FALSE, &mvpMat[0][0]);
+
+            glEnableVertexAttribArray(positionLocation);
+            glBindBuffer(GL_ARRAY_BUFFER, buffers[0]);
+            glVertexAttribPointer(positionLocation, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
+            glEnableVertexAttribArray(colorLocation);
+            glBindBuffer(GL_ARRAY_BUFFER, buffers[1]);
+            glVertexAttribPointer(colorLocation, 4, GL_FLOAT, GL_FALSE, 0, (void*)0);
+            glDrawArrays(GL_TRIANGLES, 0, positions.size());
+            glDisableVertexAttribArray(positionLocation);
+            glDisableVertexAttribArray(colorLocation);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+            if (scaled)
+            {
+                scaledTarget->present();
+            }
+
+            // 解像度の調整にはGPUの処理まで含めたコストが要るので、スケーラーが有効なときだけglFinishで待つ
+            // (CPUとGPUが毎フレーム同期するので、その待ちもフレーム時間に含まれる)
+            if (scaledTarget)
+            {
+                glFinish();
+            }
+            double cost = glfwGetTime() - frameStart;
+            frameCosts.add(cost, budget);
+            if (scaledTarget)
+            {
+                scaler.update(cost, frame);
+            }
+
+            // ダブルバッファのスワップ
+            glfwSwapBuffers(window);
+            glfwPollEvents();
+
+            pacer.wait();
+            ++frame;
+        }
+
+        printf("target %.3f ms (%.1f fps), swap interval %d, %d frames\n",
+            budget * 1000.0, targetFps, swapInterval, frame);
+        if (scaledTarget)
+        {
+            printf("  (frame time and frame cost include a glFinish every frame for the resolution scaler)\n");
+        }
+        frameTimes.print("frame time");
+        frameCosts.print(scaledTarget ? "frame cost" : "cpu cost");
+        printf("  resolution scale history (frame: scale):\n");
+        for (const std::pair<int, float>& change : scaler.history)
+        {
+            printf("    %6d: %.2f (%dx%d)\n", change.first, change.second,
+                (int)(width * change.second), (int)(height * change.second));
+        }
+
+        delete scaledTarget;
+    }
+
+    glDeleteBuffers(2, &buffers[0]);
+    glDeleteProgram(shader);
+
+#ifdef _WIN32
+    timeEndPeriod(1);
+#endif
+
+    // GLFWの終了処理
+    glfwTerminate();
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,14 @@
+#version 120
+
+//
+// present.frag
+//
+
+uniform sampler2D colorTex;
+
+varying vec2 texCoord;
+
+void main(void)
+{
+    gl_FragColor = texture2D(colorTex, texCoord);
+}
\ No newline at end of file
@@ -0,0 +1,17 @@
+#version 120
+
+//
+// present.vert
+//
+
+attribute vec2 position;
+
+uniform vec2 uvScale;
+
+varying vec2 texCoord;
+
+void main(void)
+{
+    texCoord = (position * 0.5 + 0.5) * uvScale;
+    gl_Position = vec4(position, 0.0, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,17 @@
+#version 120
+    
+//
+// shader.frag
+//
+
+uniform int iterations;
+    
+void main(void)
+{
+    float v = 0.0;
+    for (int i = 0; i < iterations; ++i)
+    {
+        v += sin(gl_FragCoord.x * 0.01 + float(i)) * cos(gl_FragCoord.y * 0.01 - float(i));
+    }
+    gl_FragColor = vec4(gl_Color.rgb * (0.9 + 0.1 * fract(v)), gl_Color.a);
+}
\ No newline at end of file
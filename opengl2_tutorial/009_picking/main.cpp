@@ -0,0 +1,1049 @@
+#include "stdafx.h"
+#include <iostream>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cfloat>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <gl/glew.h>
+#include <GLFW/glfw3.h>
+
+// glmの使う機能をインクルード
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+// SSE2が使える環境では4本のレイをまとめて交差判定する
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PICKING_USE_SSE 1
+#include <emmintrin.h>
+#else
+#define PICKING_USE_SSE 0
+#endif
+
+//using namespace glm;でもいいけどここでは一部のみ「glm::」を省力できるようにする
+using glm::vec2;
+using glm::vec3;
+using glm::vec4;
+using glm::mat4;
+
+
+GLFWwindow* initGLFW(int width, int height)
+{
+    // GLFW初期化
+    if (glfwInit() == GL_FALSE)
+    {
+        return nullptr;
+    }
+
+    // ウィンドウ生成
+    GLFWwindow* window = glfwCreateWindow(width, height, "OpenGL Sample", NULL, NULL);
+    if (!window)
+    {
+        glfwTerminate();
+        return nullptr;
+    }
+
+    // バージョン2.1指定
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 2);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
+
+    glfwMakeContextCurrent(window);
+    glfwSwapInterval(0);
+
+    // GLEW初期化
+    if (glewInit() != GLEW_OK)
+    {
+        return nullptr;
+    }
+
+    return window;
+}
+
+GLint readShaderSource(GLuint shaderObj, std::string fileName)
+{
+    //ファイルの読み込み
+    std::ifstream ifs(fileName);
+    if (!ifs)
+    {
+        std::cout << "error" << std::endl;
+        return -1;
+    }
+
+    std::string source;
+    std::string line;
+    while (getline(ifs, line))
+    {
+        source += line + "\n";
+    }
+
+    // シェーダのソースプログラムをシェーダオブジェクトへ読み込む
+    const GLchar *sourcePtr = (const GLchar *)source.c_str();
+    GLint length = source.length();
+    glShaderSource(shaderObj, 1, &sourcePtr, &length);
+
+    return 0;
+}
+
+// シェーダーのコンパイルやリンクに失敗したときにログを表示する
+void printInfoLog(GLuint object, bool isProgram)
+{
+    GLint length = 0;
+    if (isProgram)
+    {
+        glGetProgramiv(object, GL_INFO_LOG_LENGTH, &length);
+    }
+    else
+    {
+        glGetShaderiv(object, GL_INFO_LOG_LENGTH, &length);
+    }
+    if (length <= 1)
+    {
+        return;
+    }
+    std::vector<GLchar> log(length);
+    if (isProgram)
+    {
+        glGetProgramInfoLog(object, length, NULL, &log[0]);
+    }
+    else
+    {
+        glGetShaderInfoLog(object, length, NULL, &log[0]);
+    }
+    fprintf(stderr, "%s\n", &log[0]);
+}
+
+
+// 失敗したときは作ったオブジェクトを全部削除して-1を返す
+GLint makeShader(std::string vertexFileName, std::string fragmentFileName)
+{
+    // シェーダーオブジェクト作成
+    GLuint vertShaderObj = glCreateShader(GL_VERTEX_SHADER);
+    GLuint fragShaderObj = glCreateShader(GL_FRAGMENT_SHADER);
+    GLuint shader;
+
+    // シェーダーコンパイルとリンクの結果用変数
+    GLint compiled, linked;
+
+    /* シェーダーのソースプログラムの読み込み */
+    if (readShaderSource(vertShaderObj, vertexFileName) || readShaderSource(fragShaderObj, fragmentFileName))
+    {
+        glDeleteShader(vertShaderObj);
+        glDeleteShader(fragShaderObj);
+        return -1;
+    }
+
+    /* バーテックスシェーダーのソースプログラムのコンパイル */
+    glCompileShader(vertShaderObj);
+    glGetShaderiv(vertShaderObj, GL_COMPILE_STATUS, &compiled);
+    if (compiled == GL_FALSE)
+    {
+        fprintf(stderr, "Compile error in vertex shader.\n");
+        printInfoLog(vertShaderObj, false);
+        glDeleteShader(vertShaderObj);
+        glDeleteShader(fragShaderObj);
+        return -1;
+    }
+
+    /* フラグメントシェーダーのソースプログラムのコンパイル */
+    glCompileShader(fragShaderObj);
+    glGetShaderiv(fragShaderObj, GL_COMPILE_STATUS, &compiled);
+    if (compiled == GL_FALSE)
+    {
+        fprintf(stderr, "Compile error in fragment shader.\n");
+        printInfoLog(fragShaderObj, false);
+        glDeleteShader(vertShaderObj);
+        glDeleteShader(fragShaderObj);
+        return -1;
+    }
+
+    /* プログラムオブジェクトの作成 */
+    shader = glCreateProgram();
+
+    /* シェーダーオブジェクトのシェーダープログラムへの登録 */
+    glAttachShader(shader, vertShaderObj);
+    glAttachShader(shader, fragShaderObj);
+
+    /* シェーダーオブジェクトの削除 */
+    glDeleteShader(vertShaderObj);
+    glDeleteShader(fragShaderObj);
+
+    /* シェーダープログラムのリンク */
+    glLinkProgram(shader);
+    glGetProgramiv(shader, GL_LINK_STATUS, &linked);
+    if (linked == GL_FALSE)
+    {
+        fprintf(stderr, "Link error.\n");
+        printInfoLog(shader, true);
+        glDeleteProgram(shader);
+        return -1;
+    }
+
+    return shader;
+}
+
+
+// ---------------------------------------------------------------------------
+// レイとヒット情報
+// ---------------------------------------------------------------------------
+
+struct Ray
+{
+    vec3 origin;
+    vec3 direction;
+    float tMax;
+};
+
+struct PickResult
+{
+    bool hit = false;
+    int triangle = -1;      // indicesの何番目の三角形か(indices[triangle * 3]から3つ)
+    vec3 barycentric;       // 3頂点に対する重み(w0, w1, w2)
+    float distance = 0.0f;  // レイの原点からの距離(directionの長さ単位)
+    float depth = 1.0f;     // デプスバッファと同じ0～1の深度
+    vec3 position;          // モデル座標系でのヒット位置
+};
+
+
+// ---------------------------------------------------------------------------
+// 三角形メッシュのBVH(Bounding Volume Hierarchy)
+// ビン分割のSAHで構築し、葉には最大4枚の三角形を入れる。
+// 三角形は交差判定しやすいようにv0と2辺(e1, e2)の形で、BVHの葉の順番に並べ直して持つ。
+// ---------------------------------------------------------------------------
+
+class MeshBVH
+{
+public:
+    MeshBVH(const std::vector<vec3>& positions, const std::vector<GLuint>& indices)
+    {
+        int triangleCount = indices.size() / 3;
+        std::vector<vec3> boundsMin(triangleCount), boundsMax(triangleCount), centroids(triangleCount);
+        for (int i = 0; i < triangleCount; ++i)
+        {
+            vec3 a = positions[indices[i * 3 + 0]];
+            vec3 b = positions[indices[i * 3 + 1]];
+            vec3 c = positions[indices[i * 3 + 2]];
+            boundsMin[i] = glm::min(a, glm::min(b, c));
+            boundsMax[i] = glm::max(a, glm::max(b, c));
+            centroids[i] = (a + b + c) / 3.0f;
+        }
+
+        std::vector<int> order(triangleCount);
+        for (int i = 0; i < triangleCount; ++i)
+        {
+            order[i] = i;
+        }
+
+        nodes.reserve(triangleCount * 2);
+        nodes.push_back(Node());
+        if (triangleCount > 0)
+        {
+            build(0, 0, triangleCount, 0, order, boundsMin, boundsMax, centroids);
+        }
+
+        triangles.resize(triangleCount);
+        for (int i = 0; i < triangleCount; ++i)
+        {
+            int t = order[i];
+            vec3 a = positions[indices[t * 3 + 0]];
+            triangles[i].v0 = a;
+            triangles[i].e1 = positions[indices[t * 3 + 1]] - a;
+            triangles[i].e2 = positions[indices[t * 3 + 2]] - a;
+            triangles[i].id = t;
+        }
+    }
+
+    int nodeCount() const
+    {
+        return nodes.size();
+    }
+
+    // 1本のレイで一番近い三角形を探す。見つかればray.tMaxが縮む
+    bool intersect(Ray& ray, int& triangle, float& u, float& v) const
+    {
+        if (triangles.empty())
+        {
+            return false;
+        }
+
+        vec3 invDir = 1.0f / ray.direction;
+        bool hit = false;
+        // 木の深さはmaxDepthまでなので、スタックはmaxDepth + 1あれば溢れない
+        int stack[maxDepth + 1];
+        int stackSize = 0;
+        stack[stackSize++] = 0;
+        while (stackSize > 0)
+        {
+            const Node& node = nodes[stack[--stackSize]];
+            if (!intersectBox(node, ray, invDir))
+            {
+                continue;
+            }
+            if (node.count > 0)
+            {
+                for (int i = node.leftFirst; i < node.leftFirst + node.count; ++i)
+                {
+                    if (intersectTriangle(triangles[i], ray, u, v))
+                    {
+                        triangle = triangles[i].id;
+                        hit = true;
+                    }
+                }
+                continue;
+            }
+            // レイの向きに近い方の子を先に調べる(後からpushした方が先に取り出される)
+            if (ray.direction[node.axis] > 0.0f)
+            {
+                stack[stackSize++] = node.leftFirst + 1;
+                stack[stackSize++] = node.leftFirst;
+            }
+            else
+            {
+                stack[stackSize++] = node.leftFirst;
+                stack[stackSize++] = node.leftFirst + 1;
+            }
+        }
+        return hit;
+    }
+
+    // 4本のレイをまとめて調べる(画面上で近いレイをまとめると同じノードをたどりやすい)
+    void intersect4(Ray rays[4], int triangle[4], float u[4], float v[4]) const
+    {
+#if PICKING_USE_SSE
+        if (triangles.empty())
+        {
+            return;
+        }
+
+        __m128 ox = _mm_setr_ps(rays[0].origin.x, rays[1].origin.x, rays[2].origin.x, rays[3].origin.x);
+        __m128 oy = _mm_setr_ps(rays[0].origin.y, rays[1].origin.y, rays[2].origin.y, rays[3].origin.y);
+        __m128 oz = _mm_setr_ps(rays[0].origin.z, rays[1].origin.z, rays[2].origin.z, rays[3].origin.z);
+        __m128 dx = _mm_setr_ps(rays[0].direction.x, rays[1].direction.x, rays[2].direction.x, rays[3].direction.x);
+        __m128 dy = _mm_setr_ps(rays[0].direction.y, rays[1].direction.y, rays[2].direction.y, rays[3].direction.y);
+        __m128 dz = _mm_setr_ps(rays[0].direction.z, rays[1].direction.z, rays[2].direction.z, rays[3].direction.z);
+        __m128 one = _mm_set1_ps(1.0f);
+        __m128 idx = _mm_div_ps(one, dx);
+        __m128 idy = _mm_div_ps(one, dy);
+        __m128 idz = _mm_div_ps(one, dz);
+        __m128 tMax = _mm_setr_ps(rays[0].tMax, rays[1].tMax, rays[2].tMax, rays[3].tMax);
+        __m128 hitU = _mm_setzero_ps();
+        __m128 hitV = _mm_setzero_ps();
+        __m128i hitId = _mm_loadu_si128((const __m128i*)triangle);
+
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 epsilon = _mm_set1_ps(1e-7f);
+        const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+
+        // 木の深さはmaxDepthまでなので、スタックはmaxDepth + 1あれば溢れない
+        int stack[maxDepth + 1];
+        int stackSize = 0;
+        stack[stackSize++] = 0;
+        while (stackSize > 0)
+        {
+            const Node& node = nodes[stack[--stackSize]];
+
+            // スラブ法で4本のレイとAABBを同時に判定し、1本でも当たれば中へ進む
+            __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.boundsMin.x), ox), idx);
+            __m128 t2 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.boundsMax.x), ox), idx);
+            __m128 tNear = _mm_min_ps(t1, t2);
+            __m128 tFar = _mm_max_ps(t1, t2);
+            t1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.boundsMin.y), oy), idy);
+            t2 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.boundsMax.y), oy), idy);
+            tNear = _mm_max_ps(tNear, _mm_min_ps(t1, t2));
+            tFar = _mm_min_ps(tFar, _mm_max_ps(t1, t2));
+            t1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.boundsMin.z), oz), idz);
+            t2 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.boundsMax.z), oz), idz);
+            tNear = _mm_max_ps(tNear, _mm_min_ps(t1, t2));
+            tFar = _mm_min_ps(tFar, _mm_max_ps(t1, t2));
+            __m128 boxHit = _mm_and_ps(_mm_cmpge_ps(tFar, _mm_max_ps(tNear, zero)), _mm_cmple_ps(tNear, tMax));
+            if (_mm_movemask_ps(boxHit) == 0)
+            {
+                continue;
+            }
+
+            if (node.count > 0)
+            {
+                for (int i = node.leftFirst; i < node.leftFirst + node.count; ++i)
+                {
+                    const Triangle& tri = triangles[i];
+                    __m128 e1x = _mm_set1_ps(tri.e1.x), e1y = _mm_set1_ps(tri.e1.y), e1z = _mm_set1_ps(tri.e1.z);
+                    __m128 e2x = _mm_set1_ps(tri.e2.x), e2y = _mm_set1_ps(tri.e2.y), e2z = _mm_set1_ps(tri.e2.z);
+
+                    // Moller-Trumboreの交差判定を4本同時に行う
+                    __m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+                    __m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+                    __m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+                    __m128 det = dot3(e1x, e1y, e1z, px, py, pz);
+                    __m128 invDet = _mm_div_ps(one, det);
+
+                    __m128 tx = _mm_sub_ps(ox, _mm_set1_ps(tri.v0.x));
+                    __m128 ty = _mm_sub_ps(oy, _mm_set1_ps(tri.v0.y));
+                    __m128 tz = _mm_sub_ps(oz, _mm_set1_ps(tri.v0.z));
+                    __m128 triU = _mm_mul_ps(dot3(tx, ty, tz, px, py, pz), invDet);
+
+                    __m128 qx = _mm_sub_ps(_mm_mul_ps(ty, e1z), _mm_mul_ps(tz, e1y));
+                    __m128 qy = _mm_sub_ps(_mm_mul_ps(tz, e1x), _mm_mul_ps(tx, e1z));
+                    __m128 qz = _mm_sub_ps(_mm_mul_ps(tx, e1y), _mm_mul_ps(ty, e1x));
+                    __m128 triV = _mm_mul_ps(dot3(dx, dy, dz, qx, qy, qz), invDet);
+                    __m128 t = _mm_mul_ps(dot3(e2x, e2y, e2z, qx, qy, qz), invDet);
+
+                    __m128 mask = _mm_cmpgt_ps(_mm_and_ps(det, absMask), epsilon);
+                    mask = _mm_and_ps(mask, _mm_cmpge_ps(triU, zero));
+                    mask = _mm_and_ps(mask, _mm_cmpge_ps(triV, zero));
+                    mask = _mm_and_ps(mask, _mm_cmple_ps(_mm_add_ps(triU, triV), one));
+                    mask = _mm_and_ps(mask, _mm_cmpgt_ps(t, epsilon));
+                    mask = _mm_and_ps(mask, _mm_cmplt_ps(t, tMax));
+                    if (_mm_movemask_ps(mask) == 0)
+                    {
+                        continue;
+                    }
+
+                    tMax = select(mask, t, tMax);
+                    hitU = select(mask, triU, hitU);
+                    hitV = select(mask, triV, hitV);
+                    __m128i maskBits = _mm_castps_si128(mask);
+                    hitId = _mm_or_si128(_mm_and_si128(maskBits, _mm_set1_epi32(tri.id)), _mm_andnot_si128(maskBits, hitId));
+                }
+                continue;
+            }
+
+            // 先頭のレイの向きで近い方の子を先に調べる
+            if (rays[0].direction[node.axis] > 0.0f)
+            {
+                stack[stackSize++] = node.leftFirst + 1;
+                stack[stackSize++] = node.leftFirst;
+            }
+            else
+            {
+                stack[stackSize++] = node.leftFirst;
+                stack[stackSize++] = node.leftFirst + 1;
+            }
+        }
+
+        float tOut[4];
+        _mm_storeu_ps(tOut, tMax);
+        _mm_storeu_ps(u, hitU);
+        _mm_storeu_ps(v, hitV);
+        _mm_storeu_si128((__m128i*)triangle, hitId);
+        for (int i = 0; i < 4; ++i)
+        {
+            rays[i].tMax = tOut[i];
+        }
+#else
+        for (int i = 0; i < 4; ++i)
+        {
+            intersect(rays[i], triangle[i], u[i], v[i]);
+        }
+#endif
+    }
+
+private:
+    struct Node
+    {
+        vec3 boundsMin;
+        int leftFirst;      // 葉なら最初の三角形、内部ノードなら左の子(右の子はその次)
+        vec3 boundsMax;
+        int count = 0;      // 葉の三角形数。0なら内部ノード
+        int axis = 0;       // 内部ノードの分割軸
+    };
+
+    // 木の深さの上限。これより深くなる場合は残りを全部1つの葉にする
+    static const int maxDepth = 48;
+
+    struct Triangle
+    {
+        vec3 v0, e1, e2;
+        int id;
+    };
+
+    void build(int nodeIndex, int first, int count, int depth, std::vector<int>& order,
+        const std::vector<vec3>& boundsMin, const std::vector<vec3>& boundsMax, const std::vector<vec3>& centroids)
+    {
+        vec3 nodeMin(FLT_MAX), nodeMax(-FLT_MAX), centroidMin(FLT_MAX), centroidMax(-FLT_MAX);
+        for (int i = first; i < first + count; ++i)
+        {
+            int t = order[i];
+            nodeMin = glm::min(nodeMin, boundsMin[t]);
+            nodeMax = glm::max(nodeMax, boundsMax[t]);
+            centroidMin = glm::min(centroidMin, centroids[t]);
+            centroidMax = glm::max(centroidMax, centroids[t]);
+        }
+        nodes[nodeIndex].boundsMin = nodeMin;
+        nodes[nodeIndex].boundsMax = nodeMax;
+
+        const int maxLeafSize = 4;
+        if (count <= maxLeafSize || depth >= maxDepth)
+        {
+            makeLeaf(nodeIndex, first, count);
+            return;
+        }
+
+        // 重心の広がりが一番大きい軸で分割する
+        vec3 extent = centroidMax - centroidMin;
+        int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+        if (extent[axis] <= 0.0f)
+        {
+            // 重心が全部同じ位置にある。大きな葉にならないよう並び順の半分で分ける
+            split(nodeIndex, first, count, first + count / 2, axis, depth, order, boundsMin, boundsMax, centroids);
+            return;
+        }
+
+        // ビンごとに三角形数とAABBを集め、SAHのコストが一番小さい境界を選ぶ
+        const int binCount = 12;
+        int binTriangles[binCount] = {};
+        vec3 binMin[binCount], binMax[binCount];
+        for (int b = 0; b < binCount; ++b)
+        {
+            binMin[b] = vec3(FLT_MAX);
+            binMax[b] = vec3(-FLT_MAX);
+        }
+        float binScale = binCount / extent[axis];
+        auto binOf = [&](int t) {
+            return std::min(binCount - 1, (int)((centroids[t][axis] - centroidMin[axis]) * binScale));
+        };
+        for (int i = first; i < first + count; ++i)
+        {
+            int t = order[i];
+            int b = binOf(t);
+            ++binTriangles[b];
+            binMin[b] = glm::min(binMin[b], boundsMin[t]);
+            binMax[b] = glm::max(binMax[b], boundsMax[t]);
+        }
+
+        float leftArea[binCount], rightArea[binCount];
+        int leftCount[binCount], rightCount[binCount];
+        vec3 accumMin(FLT_MAX), accumMax(-FLT_MAX);
+        int accumCount = 0;
+        for (int b = 0; b < binCount - 1; ++b)
+        {
+            accumCount += binTriangles[b];
+            if (binTriangles[b] > 0)
+            {
+                accumMin = glm::min(accumMin, binMin[b]);
+                accumMax = glm::max(accumMax, binMax[b]);
+            }
+            leftCount[b] = accumCount;
+            leftArea[b] = accumCount > 0 ? surfaceArea(accumMin, accumMax) : 0.0f;
+        }
+        accumMin = vec3(FLT_MAX);
+        accumMax = vec3(-FLT_MAX);
+        accumCount = 0;
+        for (int b = binCount - 1; b > 0; --b)
+        {
+            accumCount += binTriangles[b];
+            if (binTriangles[b] > 0)
+            {
+                accumMin = glm::min(accumMin, binMin[b]);
+                accumMax = glm::max(accumMax, binMax[b]);
+            }
+            rightCount[b - 1] = accumCount;
+            rightArea[b - 1] = accumCount > 0 ? surfaceArea(accumMin, accumMax) : 0.0f;
+        }
+
+        int bestSplit = -1;
+        float bestCost = FLT_MAX;
+        for (int b = 0; b < binCount - 1; ++b)
+        {
+            if (leftCount[b] == 0 || rightCount[b] == 0)
+            {
+                continue;
+            }
+            float cost = leftArea[b] * leftCount[b] + rightArea[b] * rightCount[b];
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                bestSplit = b;
+            }
+        }
+
+        int middle;
+        if (bestSplit < 0)
+        {
+            // ビンで分けられなかったら重心の中央値で分ける
+            middle = first + count / 2;
+            std::nth_element(order.begin() + first, order.begin() + middle, order.begin() + first + count,
+                [&](int a, int b) { return centroids[a][axis] < centroids[b][axis]; });
+        }
+        else
+        {
+            middle = std::partition(order.begin() + first, order.begin() + first + count,
+                [&](int t) { return binOf(t) <= bestSplit; }) - order.begin();
+        }
+
+        split(nodeIndex, first, count, middle, axis, depth, order, boundsMin, boundsMax, centroids);
+    }
+
+    // [first, middle)を左の子、[middle, first + count)を右の子にして再帰する
+    void split(int nodeIndex, int first, int count, int middle, int axis, int depth, std::vector<int>& order,
+        const std::vector<vec3>& boundsMin, const std::vector<vec3>& boundsMax, const std::vector<vec3>& centroids)
+    {
+        int left = nodes.size();
+        nodes.push_back(Node());
+        nodes.push_back(Node());
+        nodes[nodeIndex].leftFirst = left;
+        nodes[nodeIndex].count = 0;
+        nodes[nodeIndex].axis = axis;
+        build(left, first, middle - first, depth + 1, order, boundsMin, boundsMax, centroids);
+        build(left + 1, middle, first + count - middle, depth + 1, order, boundsMin, boundsMax, centroids);
+    }
+
+    void makeLeaf(int nodeIndex, int first, int count)
+    {
+        nodes[nodeIndex].leftFirst = first;
+        nodes[nodeIndex].count = count;
+    }
+
+    static float surfaceArea(vec3 boundsMin, vec3 boundsMax)
+    {
+        vec3 e = boundsMax - boundsMin;
+        return 2.0f * (e.x * e.y + e.y * e.z + e.z * e.x);
+    }
+
+    static bool intersectBox(const Node& node, const Ray& ray, vec3 invDir)
+    {
+        float tNear = 0.0f, tFar = ray.tMax;
+        for (int a = 0; a < 3; ++a)
+        {
+            float t1 = (node.boundsMin[a] - ray.origin[a]) * invDir[a];
+            float t2 = (node.boundsMax[a] - ray.origin[a]) * invDir[a];
+            tNear = std::max(tNear, std::min(t1, t2));
+            tFar = std::min(tFar, std::max(t1, t2));
+        }
+        return tNear <= tFar;
+    }
+
+    // Moller-Trumboreの交差判定。当たればray.tMaxと重心座標を更新する
+    static bool intersectTriangle(const Triangle& tri, Ray& ray, float& u, float& v)
+    {
+        vec3 p = glm::cross(ray.direction, tri.e2);
+        float det = glm::dot(tri.e1, p);
+        if (std::fabs(det) <= 1e-7f)
+        {
+            return false;
+        }
+        float invDet = 1.0f / det;
+        vec3 s = ray.origin - tri.v0;
+        float triU = glm::dot(s, p) * invDet;
+        if (triU < 0.0f || triU > 1.0f)
+        {
+            return false;
+        }
+        vec3 q = glm::cross(s, tri.e1);
+        float triV = glm::dot(ray.direction, q) * invDet;
+        if (triV < 0.0f || triU + triV > 1.0f)
+        {
+            return false;
+        }
+        float t = glm::dot(tri.e2, q) * invDet;
+        if (t <= 1e-7f || t >= ray.tMax)
+        {
+            return false;
+        }
+        ray.tMax = t;
+        u = triU;
+        v = triV;
+        return true;
+    }
+
+#if PICKING_USE_SSE
+    static __m128 dot3(__m128 ax, __m128 ay, __m128 az, __m128 bx, __m128 by, __m128 bz)
+    {
+        return _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(ay, by)), _mm_mul_ps(az, bz));
+    }
+
+    static __m128 select(__m128 mask, __m128 a, __m128 b)
+    {
+        return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+    }
+#endif
+
+    std::vector<Node> nodes;
+    std::vector<Triangle> triangles;
+};
+
+
+// ---------------------------------------------------------------------------
+// ピッキング
+// 画面上の点を現在のModel/View/Projection行列の逆行列で変換し、モデル座標系のレイにしてBVHを調べる。
+// ---------------------------------------------------------------------------
+
+class Picker
+{
+public:
+    Picker(const MeshBVH& bvh)
+        : bvh(bvh)
+    {
+    }
+
+    // 描画に使っているのと同じ行列を設定する
+    void setMatrices(const mat4& modelMat, const mat4& viewMat, const mat4& projectionMat, int width, int height)
+    {
+        mvpMat = projectionMat * viewMat * modelMat;
+        // glm::unProjectは呼ぶたびに逆行列を計算するので、ここで1回だけ求めておく
+        inverseMvpMat = glm::inverse(mvpMat);
+        viewport = vec4(0.0f, 0.0f, (float)width, (float)height);
+    }
+
+    // (x, y)はウィンドウ左上が原点のピクセル座標(glfwGetCursorPosと同じ)
+    Ray screenRay(double x, double y) const
+    {
+        // OpenGLのウィンドウ座標は左下が原点。正規化デバイス座標の近い面(z = -1)と遠い面(z = 1)を逆変換する
+        float ndcX = ((float)x - viewport.x) / viewport.z * 2.0f - 1.0f;
+        float ndcY = (viewport.w - (float)y - viewport.y) / viewport.w * 2.0f - 1.0f;
+        vec4 nearPoint = inverseMvpMat * vec4(ndcX, ndcY, -1.0f, 1.0f);
+        vec4 farPoint = inverseMvpMat * vec4(ndcX, ndcY, 1.0f, 1.0f);
+        vec3 nearPosition = vec3(nearPoint.x, nearPoint.y, nearPoint.z) / nearPoint.w;
+        vec3 farPosition = vec3(farPoint.x, farPoint.y, farPoint.z) / farPoint.w;
+
+        // directionは正規化せず、t = 0が近クリップ面、t = 1が遠クリップ面になるようにする
+        Ray ray;
+        ray.origin = nearPosition;
+        ray.direction = farPosition - nearPosition;
+        ray.tMax = 1.0f;
+        return ray;
+    }
+
+    PickResult pick(double x, double y) const
+    {
+        Ray ray = screenRay(x, y);
+        int triangle = -1;
+        float u = 0.0f, v = 0.0f;
+        bool hit = bvh.intersect(ray, triangle, u, v);
+        return makeResult(ray, hit, triangle, u, v);
+    }
+
+    // 大量の点をまとめて調べる。近い点が同じパケットになるように並べておくと速い
+    void pickBatch(const std::vector<vec2>& points, std::vector<PickResult>& results) const
+    {
+        results.resize(points.size());
+        size_t i = 0;
+        for (; i + 4 <= points.size(); i += 4)
+        {
+            Ray rays[4];
+            int triangles[4] = { -1, -1, -1, -1 };
+            float u[4] = {}, v[4] = {};
+            for (int k = 0; k < 4; ++k)
+            {
+                rays[k] = screenRay(points[i + k].x, points[i + k].y);
+            }
+            bvh.intersect4(rays, triangles, u, v);
+            for (int k = 0; k < 4; ++k)
+            {
+                results[i + k] = makeResult(rays[k], triangles[k] >= 0, triangles[k], u[k], v[k]);
+            }
+        }
+        // 4つに満たない残り
+        for (; i < points.size(); ++i)
+        {
+            results[i] = pick(points[i].x, points[i].y);
+        }
+    }
+
+private:
+    PickResult makeResult(const Ray& ray, bool hit, int triangle, float u, float v) const
+    {
+        PickResult result;
+        if (!hit)
+        {
+            return result;
+        }
+        result.hit = true;
+        result.triangle = triangle;
+        result.barycentric = vec3(1.0f - u - v, u, v);
+        result.position = ray.origin + ray.direction * ray.tMax;
+        result.distance = ray.tMax * glm::length(ray.direction);
+        // ヒット位置を投影してデプスバッファと同じ深度を求める
+        vec4 clip = mvpMat * vec4(result.position, 1.0f);
+        result.depth = clip.z / clip.w * 0.5f + 0.5f;
+        return result;
+    }
+
+    const MeshBVH& bvh;
+    mat4 mvpMat, inverseMvpMat;
+    vec4 viewport;
+};
+
+
+// 比較用: BVHを使わずに全三角形を調べる
+PickResult pickBruteForce(const Picker& picker, const std::vector<vec3>& positions, const std::vector<GLuint>& indices, double x, double y)
+{
+    Ray ray = picker.screenRay(x, y);
+    PickResult result;
+    for (size_t i = 0; i + 2 < indices.size(); i += 3)
+    {
+        vec3 v0 = positions[indices[i]];
+        vec3 e1 = positions[indices[i + 1]] - v0;
+        vec3 e2 = positions[indices[i + 2]] - v0;
+        vec3 p = glm::cross(ray.direction, e2);
+        float det = glm::dot(e1, p);
+        if (std::fabs(det) <= 1e-7f) continue;
+        float invDet = 1.0f / det;
+        vec3 s = ray.origin - v0;
+        float u = glm::dot(s, p) * invDet;
+        if (u < 0.0f || u > 1.0f) continue;
+        vec3 q = glm::cross(s, e1);
+        float v = glm::dot(ray.direction, q) * invDet;
+        if (v < 0.0f || u + v > 1.0f) continue;
+        float t = glm::dot(e2, q) * invDet;
+        if (t <= 1e-7f || t >= ray.tMax) continue;
+        ray.tMax = t;
+        result.hit = true;
+        result.triangle = i / 3;
+        result.barycentric = vec3(1.0f - u - v, u, v);
+    }
+    return result;
+}
+
+
+// 起伏のある格子状のメッシュを作る(grid x grid個の四角形 = 2 * grid * grid枚の三角形)
+void makeTerrain(int grid, std::vector<vec3>& positions, std::vector<GLuint>& indices)
+{
+    positions.clear();
+    indices.clear();
+    for (int y = 0; y <= grid; ++y)
+    {
+        for (int x = 0; x <= grid; ++x)
+        {
+            float fx = (float)x / grid * 4.0f - 2.0f;
+            float fy = (float)y / grid * 4.0f - 2.0f;
+            positions.push_back(vec3(fx, fy, 0.3f * std::sin(fx * 3.0f) * std::cos(fy * 2.0f)));
+        }
+    }
+    for (int y = 0; y < grid; ++y)
+    {
+        for (int x = 0; x < grid; ++x)
+        {
+            GLuint i0 = y * (grid + 1) + x;
+            GLuint i1 = i0 + 1;
+            GLuint i2 = i0 + grid + 1;
+            GLuint i3 = i2 + 1;
+            GLuint quad[6] = { i0, i1, i3, i0, i3, i2 };
+            indices.insert(indices.end(), quad, quad + 6);
+        }
+    }
+}
+
+
+// 使い方: 009_picking [格子の分割数] [一括ピッキングのレイ数(一辺)]
+int main(int argc, char* argv[])
+{
+    GLint width = 640, height = 480;
+    int grid = argc > 1 ? atoi(argv[1]) : 256;
+    int batchSide = argc > 2 ? atoi(argv[2]) : 64;
+
+    // grid 0だとメッシュが空になり、batchSideが2未満だとまとめて調べるレイが無い
+    if (grid < 1 || batchSide < 2)
+    {
+        fprintf(stderr, "Grid size must be at least 1 and batch side at least 2.\n");
+        return -1;
+    }
+
+    GLFWwindow* window = initGLFW(width, height);
+
+    GLint shader = makeShader("shader.vert", "shader.frag");
+
+    std::vector<vec3> positions;
+    std::vector<GLuint> indices;
+    makeTerrain(grid, positions, indices);
+
+    double buildStart = glfwGetTime();
+    MeshBVH bvh(positions, indices);
+    double buildSeconds = glfwGetTime() - buildStart;
+
+    // attribute を指定する
+    GLint positionLocation = glGetAttribLocation(shader, "position");
+    // 頂点バッファオブジェクトを作成
+    GLuint buffers[2];
+    glGenBuffers(2, &buffers[0]);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers[0]);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint) * indices.size(), &indices[0], GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, buffers[1]);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vec3) * positions.size(), &positions[0], GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    GLuint matrixID = glGetUniformLocation(shader, "MVP");
+    GLuint highlightID = glGetUniformLocation(shader, "highlight");
+
+    // 宣言時には単位行列が入っている
+    mat4 modelMat, viewMat, projectionMat;
+
+    // View行列を計算
+    viewMat = glm::lookAt(
+        vec3(3.0, 3.0, 3.0), // ワールド空間でのカメラの座標
+        vec3(0.0, 0.0, 0.0), // 見ている位置の座標
+        vec3(0.0, 0.0, 1.0)  // 上方向を示す。(0,1.0,0)に設定するとy軸が上になります
+    );
+
+    // Projection行列を計算
+    projectionMat = glm::perspective(
+        glm::radians(45.0f), // ズームの度合い(通常90～30)
+        (GLfloat)width / (GLfloat)height,		// アスペクト比
+        0.1f,		// 近くのクリッピング平面
+        100.0f		// 遠くのクリッピング平面
+    );
+
+    Picker picker(bvh);
+    picker.setMatrices(modelMat, viewMat, projectionMat, width, height);
+
+    // ベンチマーク
+    {
+        // 画面上のランダムな点(1本ずつ)
+        std::vector<vec2> randomPoints(10000);
+        uint32_t rng = 2463534242u;
+        for (vec2& p : randomPoints)
+        {
+            rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+            p.x = (float)(rng % width);
+            rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+            p.y = (float)(rng % height);
+        }
+
+        double start = glfwGetTime();
+        int hits = 0;
+        for (const vec2& p : randomPoints)
+        {
+            hits += picker.pick(p.x, p.y).hit;
+        }
+        double bvhSeconds = glfwGetTime() - start;
+
+        // 全三角形を調べる方法は遅いので本数を減らす
+        int bruteCount = 100;
+        std::vector<PickResult> bruteResults(bruteCount);
+        start = glfwGetTime();
+        for (int i = 0; i < bruteCount; ++i)
+        {
+            bruteResults[i] = pickBruteForce(picker, positions, indices, randomPoints[i].x, randomPoints[i].y);
+        }
+        double bruteSeconds = glfwGetTime() - start;
+        int mismatches = 0;
+        for (int i = 0; i < bruteCount; ++i)
+        {
+            mismatches += bruteResults[i].triangle != picker.pick(randomPoints[i].x, randomPoints[i].y).triangle;
+        }
+
+        // 一括: 2x2ピクセルごとにパケットにする
+        std::vector<vec2> batchPoints;
+        for (int y = 0; y < batchSide; y += 2)
+        {
+            for (int x = 0; x < batchSide; x += 2)
+            {
+                for (int k = 0; k < 4; ++k)
+                {
+                    float px = (x + (k & 1) + 0.5f) * width / batchSide;
+                    float py = (y + (k >> 1) + 0.5f) * height / batchSide;
+                    batchPoints.push_back(vec2(px, py));
+                }
+            }
+        }
+        std::vector<PickResult> batchResults;
+        const int batchRepeat = 20;
+        start = glfwGetTime();
+        for (int r = 0; r < batchRepeat; ++r)
+        {
+            picker.pickBatch(batchPoints, batchResults);
+        }
+        double packetSeconds = (glfwGetTime() - start) / batchRepeat;
+
+        start = glfwGetTime();
+        int batchMismatches = 0;
+        for (int r = 0; r < batchRepeat; ++r)
+        {
+            for (size_t i = 0; i < batchPoints.size(); ++i)
+            {
+                PickResult single = picker.pick(batchPoints[i].x, batchPoints[i].y);
+                batchMismatches += r == 0 && single.triangle != batchResults[i].triangle;
+            }
+        }
+        double singleSeconds = (glfwGetTime() - start) / batchRepeat;
+
+        printf("%zu triangles, %d BVH nodes, build %.2f ms\n", indices.size() / 3, bvh.nodeCount(), buildSeconds * 1000.0);
+        printf("  single ray, BVH     %8.3f us/query  (%d/%zu hit)\n",
+            bvhSeconds * 1e6 / randomPoints.size(), hits, randomPoints.size());
+        printf("  single ray, brute   %8.3f us/query  (%d mismatches vs BVH)\n",
+            bruteSeconds * 1e6 / bruteCount, mismatches);
+        printf("  batch %zu rays: packets %.3f ms (%.2f Mrays/s), single rays %.3f ms (%.2f Mrays/s), %d mismatches\n",
+            batchPoints.size(), packetSeconds * 1000.0, batchPoints.size() / packetSeconds / 1e6,
+            singleSeconds * 1000.0, batchPoints.size() / singleSeconds / 1e6, batchMismatches);
+    }
+
+    int pickedTriangle = -1;
+    bool wasPressed = false;
+
+    // フレームループ
+    while (glfwWindowShouldClose(window) == GL_FALSE)
+    {
+        // クリックされたらカーソルの下の三角形を調べる
+        bool pressed = glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS;
+        if (pressed && !wasPressed)
+        {
+            double cursorX, cursorY;
+            int windowWidth, windowHeight;
+            glfwGetCursorPos(window, &cursorX, &cursorY);
+            glfwGetWindowSize(window, &windowWidth, &windowHeight);
+            // ウィンドウの大きさが変わっていてもビューポートの座標に合わせる
+            cursorX = cursorX * width / windowWidth;
+            cursorY = cursorY * height / windowHeight;
+
+            double start = glfwGetTime();
+            PickResult result = picker.pick(cursorX, cursorY);
+            double elapsed = glfwGetTime() - start;
+            if (result.hit)
+            {
+                printf("triangle %d  barycentric (%.3f, %.3f, %.3f)  distance %.4f  depth %.6f  (%.2f us)\n",
+                    result.triangle, result.barycentric.x, result.barycentric.y, result.barycentric.z,
+                    result.distance, result.depth, elapsed * 1e6);
+            }
+            else
+            {
+                printf("no hit (%.2f us)\n", elapsed * 1e6);
+            }
+            pickedTriangle = result.triangle;
+        }
+        wasPressed = pressed;
+
+        glUseProgram(shader);
+
+        glEnable(GL_DEPTH_TEST);
+        glDepthFunc(GL_LEQUAL);
+        glClearColor(0.2f, 0.2f, 0.2f, 0.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        // ModelViewProjection行列を計算
+        mat4 mvpMat = projectionMat * viewMat* modelMat;
+        glUniformMatrix4fv(matrixID, 1, GL_FALSE, &mvpMat[0][0]);
+        glUniform4f(highlightID, 0.0f, 0.0f, 0.0f, 0.0f);
+
+        glEnableVertexAttribArray(positionLocation);
+        glBindBuffer(GL_ARRAY_BUFFER, buffers[1]);
+        glVertexAttribPointer(positionLocation, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
+
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers[0]);
+        glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, (void*)0);
+
+        // 選ばれた三角形だけ同じインデックスバッファから描き直す
+        if (pickedTriangle >= 0)
+        {
+            glUniform4f(highlightID, 1.0f, 1.0f, 1.0f, 1.0f);
+            glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_INT, (void*)(sizeof(GLuint) * 3 * pickedTriangle));
+        }
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        // ダブルバッファのスワップ
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+    }
+
+    glDeleteBuffers(2, &buffers[0]);
+    glDeleteProgram(shader);
+
+    // GLFWの終了処理
+    glfwTerminate();
+
+    return 0;
+}
\ No newline at end of file
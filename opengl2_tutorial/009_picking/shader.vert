@@ -0,0 +1,17 @@
+#version 120
+
+//
+// shader.vert
+//
+
+attribute vec3 position;
+
+uniform mat4 MVP;
+uniform vec4 highlight;
+
+void main(void)
+{
+    gl_Position = MVP * vec4(position, 1.0);
+    vec4 heightColor = vec4(0.3 + position.z, 0.5, 0.8 - position.z, 1.0);
+    gl_FrontColor = mix(heightColor, vec4(highlight.rgb, 1.0), highlight.a);
+}
\ No newline at end of file
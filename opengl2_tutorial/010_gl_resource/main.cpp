@@ -0,0 +1,762 @@
+#include "stdafx.h"
+#include <iostream>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <gl/glew.h>
+#include <GLFW/glfw3.h>
+
+// glmの使う機能をインクルード
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+//using namespace glm;でもいいけどここでは一部のみ「glm::」を省力できるようにする
+using glm::vec3;
+using glm::vec4;
+using glm::mat4;
+
+
+GLFWwindow* initGLFW(int width, int height)
+{
+    // GLFW初期化
+    if (glfwInit() == GL_FALSE)
+    {
+        return nullptr;
+    }
+
+    // ウィンドウ生成
+    GLFWwindow* window = glfwCreateWindow(width, height, "OpenGL Sample", NULL, NULL);
+    if (!window)
+    {
+        glfwTerminate();
+        return nullptr;
+    }
+
+    // バージョン2.1指定
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 2);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
+
+    glfwMakeContextCurrent(window);
+    glfwSwapInterval(0);
+
+    // GLEW初期化
+    if (glewInit() != GLEW_OK)
+    {
+        return nullptr;
+    }
+
+    return window;
+}
+
+GLint readShaderSource(GLuint shaderObj, std::string fileName)
+{
+    //ファイルの読み込み
+    std::ifstream ifs(fileName);
+    if (!ifs)
+    {
+        std::cout << "error" << std::endl;
+        return -1;
+    }
+
+    std::string source;
+    std::string line;
+    while (getline(ifs, line))
+    {
+        source += line + "\n";
+    }
+
+    // シェーダのソースプログラムをシェーダオブジェクトへ読み込む
+    const GLchar *sourcePtr = (const GLchar *)source.c_str();
+    GLint length = source.length();
+    glShaderSource(shaderObj, 1, &sourcePtr, &length);
+
+    return 0;
+}
+
+
+// ---------------------------------------------------------------------------
+// GLリソースのレジストリ
+// プログラム・シェーダー・バッファ・テクスチャの生成と削除をここに集め、
+// 種類ごとの生存数、確保しているバイト数、フレームごとの転送バイト数を数える。
+//
+// 削除はすぐには行わず、endFrameでまとめてglDelete*する。描画の途中で削除して
+// ドライバーが同期するのを避けるためと、別スレッドでハンドルが破棄されても
+// GLの呼び出しはコンテキストのあるスレッドだけで行うため。
+// ---------------------------------------------------------------------------
+
+enum class GLResourceType
+{
+    Program,
+    Shader,
+    Buffer,
+    Texture,
+    Count,
+};
+
+const int resourceTypeCount = (int)GLResourceType::Count;
+
+const char* resourceTypeName(GLResourceType type)
+{
+    switch (type)
+    {
+    case GLResourceType::Program: return "program";
+    case GLResourceType::Shader: return "shader";
+    case GLResourceType::Buffer: return "buffer";
+    case GLResourceType::Texture: return "texture";
+    default: return "unknown";
+    }
+}
+
+// 実行中に取り出せる統計
+struct GLResourceStats
+{
+    int live[resourceTypeCount] = {};               // 生存中のオブジェクト数
+    int peakLive[resourceTypeCount] = {};
+    long long created[resourceTypeCount] = {};
+    long long destroyed[resourceTypeCount] = {};
+    long long bytes[resourceTypeCount] = {};        // 確保しているバイト数(バッファとテクスチャ)
+    long long peakBytes[resourceTypeCount] = {};
+    long long uploadBytesLastFrame = 0;             // 直前のフレームでCPUからGPUへ送ったバイト数
+    long long uploadBytesPeakFrame = 0;
+    long long uploadBytesTotal = 0;
+    long long frames = 0;
+    int pendingDeletes = 0;                         // 次のendFrameで削除されるオブジェクト数
+};
+
+class GLResourceRegistry
+{
+public:
+    GLResourceRegistry() = default;
+    GLResourceRegistry(const GLResourceRegistry&) = delete;
+    GLResourceRegistry& operator=(const GLResourceRegistry&) = delete;
+
+    // GLオブジェクトを作って登録する。shaderTypeはシェーダーのときだけ使う
+    GLuint create(GLResourceType type, GLenum shaderType = 0)
+    {
+        GLuint id = 0;
+        switch (type)
+        {
+        case GLResourceType::Program: id = glCreateProgram(); break;
+        case GLResourceType::Shader: id = glCreateShader(shaderType); break;
+        case GLResourceType::Buffer: glGenBuffers(1, &id); break;
+        case GLResourceType::Texture: glGenTextures(1, &id); break;
+        default: break;
+        }
+        if (id == 0)
+        {
+            return 0;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        int t = (int)type;
+        objects[t][id] = Entry();
+        ++current.created[t];
+        ++current.live[t];
+        current.peakLive[t] = std::max(current.peakLive[t], current.live[t]);
+        return id;
+    }
+
+    // 削除を予約する。どのスレッドから呼んでもよい
+    void release(GLResourceType type, GLuint id)
+    {
+        if (id == 0)
+        {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        pendingDeletes[(int)type].push_back(id);
+        ++current.pendingDeletes;
+    }
+
+    // オブジェクトが確保しているGPUメモリの大きさを更新する
+    void setBytes(GLResourceType type, GLuint id, long long bytes)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        int t = (int)type;
+        auto it = objects[t].find(id);
+        if (it == objects[t].end())
+        {
+            return;
+        }
+        current.bytes[t] += bytes - it->second.bytes;
+        current.peakBytes[t] = std::max(current.peakBytes[t], current.bytes[t]);
+        it->second.bytes = bytes;
+    }
+
+    // デバッグ用の名前(終了時のリーク一覧に出る)
+    void setLabel(GLResourceType type, GLuint id, const std::string& label)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = objects[(int)type].find(id);
+        if (it != objects[(int)type].end())
+        {
+            it->second.label = label;
+        }
+    }
+
+    void addUploadBytes(long long bytes)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        uploadBytesThisFrame += bytes;
+    }
+
+    // フレームの区切り(glfwSwapBuffersの後)で呼ぶ。予約された削除をまとめて行う
+    void endFrame()
+    {
+        std::vector<GLuint> deletes[resourceTypeCount];
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (int t = 0; t < resourceTypeCount; ++t)
+            {
+                deletes[t].swap(pendingDeletes[t]);
+                for (GLuint id : deletes[t])
+                {
+                    auto it = objects[t].find(id);
+                    if (it != objects[t].end())
+                    {
+                        current.bytes[t] -= it->second.bytes;
+                        objects[t].erase(it);
+                    }
+                    ++current.destroyed[t];
+                    --current.live[t];
+                }
+            }
+            current.pendingDeletes = 0;
+
+            current.uploadBytesLastFrame = uploadBytesThisFrame;
+            current.uploadBytesPeakFrame = std::max(current.uploadBytesPeakFrame, uploadBytesThisFrame);
+            current.uploadBytesTotal += uploadBytesThisFrame;
+            uploadBytesThisFrame = 0;
+            ++current.frames;
+        }
+
+        // バッファとテクスチャは配列で一度に削除できる
+        if (!deletes[(int)GLResourceType::Buffer].empty())
+        {
+            glDeleteBuffers(deletes[(int)GLResourceType::Buffer].size(), &deletes[(int)GLResourceType::Buffer][0]);
+        }
+        if (!deletes[(int)GLResourceType::Texture].empty())
+        {
+            glDeleteTextures(deletes[(int)GLResourceType::Texture].size(), &deletes[(int)GLResourceType::Texture][0]);
+        }
+        for (GLuint id : deletes[(int)GLResourceType::Shader])
+        {
+            glDeleteShader(id);
+        }
+        for (GLuint id : deletes[(int)GLResourceType::Program])
+        {
+            glDeleteProgram(id);
+        }
+    }
+
+    GLResourceStats stats() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return current;
+    }
+
+    // 統計と、まだ生きているオブジェクトの一覧を出力する
+    void dump(FILE* out) const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        fprintf(out, "GL resources after %lld frames\n", current.frames);
+        fprintf(out, "  %-8s %6s %6s %8s %8s %12s %12s\n", "type", "live", "peak", "created", "deleted", "bytes", "peak bytes");
+        for (int t = 0; t < resourceTypeCount; ++t)
+        {
+            fprintf(out, "  %-8s %6d %6d %8lld %8lld %12lld %12lld\n", resourceTypeName((GLResourceType)t),
+                current.live[t], current.peakLive[t], current.created[t], current.destroyed[t],
+                current.bytes[t], current.peakBytes[t]);
+        }
+        fprintf(out, "  upload: last frame %lld bytes, peak %lld bytes/frame, average %.0f bytes/frame\n",
+            current.uploadBytesLastFrame, current.uploadBytesPeakFrame,
+            current.frames > 0 ? (double)current.uploadBytesTotal / current.frames : 0.0);
+        for (int t = 0; t < resourceTypeCount; ++t)
+        {
+            for (const auto& object : objects[t])
+            {
+                fprintf(out, "  live %s %u %s (%lld bytes)\n", resourceTypeName((GLResourceType)t),
+                    object.first, object.second.label.c_str(), object.second.bytes);
+            }
+        }
+    }
+
+    // glfwTerminateの前に呼ぶ。予約された削除を済ませ、残っているものをリークとして報告する
+    void shutdown()
+    {
+        endFrame();
+        dump(stdout);
+
+        int leaks = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (int t = 0; t < resourceTypeCount; ++t)
+            {
+                leaks += objects[t].size();
+            }
+        }
+        if (leaks > 0)
+        {
+            fprintf(stderr, "%d GL objects were not released.\n", leaks);
+        }
+    }
+
+private:
+    struct Entry
+    {
+        long long bytes = 0;
+        std::string label;
+    };
+
+    mutable std::mutex mutex;
+    std::unordered_map<GLuint, Entry> objects[resourceTypeCount];
+    std::vector<GLuint> pendingDeletes[resourceTypeCount];
+    GLResourceStats current;
+    long long uploadBytesThisFrame = 0;
+};
+
+
+// ---------------------------------------------------------------------------
+// RAIIハンドル
+// スコープを抜けるとレジストリに削除を予約する。コピーはできず、ムーブだけできる。
+// ---------------------------------------------------------------------------
+
+template <GLResourceType Type>
+class GLHandle
+{
+public:
+    GLHandle() = default;
+
+    explicit GLHandle(GLResourceRegistry& registry, GLenum shaderType = 0)
+        : registry(&registry), id(registry.create(Type, shaderType))
+    {
+    }
+
+    ~GLHandle()
+    {
+        reset();
+    }
+
+    GLHandle(const GLHandle&) = delete;
+    GLHandle& operator=(const GLHandle&) = delete;
+
+    GLHandle(GLHandle&& other)
+        : registry(other.registry), id(other.id)
+    {
+        other.id = 0;
+    }
+
+    GLHandle& operator=(GLHandle&& other)
+    {
+        if (this != &other)
+        {
+            reset();
+            registry = other.registry;
+            id = other.id;
+            other.id = 0;
+        }
+        return *this;
+    }
+
+    void reset()
+    {
+        if (registry && id)
+        {
+            registry->release(Type, id);
+        }
+        id = 0;
+    }
+
+    GLuint get() const
+    {
+        return id;
+    }
+
+    explicit operator bool() const
+    {
+        return id != 0;
+    }
+
+    void setLabel(const std::string& label)
+    {
+        if (registry && id)
+        {
+            registry->setLabel(Type, id, label);
+        }
+    }
+
+protected:
+    GLResourceRegistry* registry = nullptr;
+    GLuint id = 0;
+};
+
+typedef GLHandle<GLResourceType::Shader> ShaderObject;
+typedef GLHandle<GLResourceType::Program> ProgramObject;
+
+class BufferObject : public GLHandle<GLResourceType::Buffer>
+{
+public:
+    BufferObject() = default;
+
+    explicit BufferObject(GLResourceRegistry& registry)
+        : GLHandle(registry)
+    {
+    }
+
+    // glBufferDataと同じ。確保したサイズと転送量を記録する
+    // 空のハンドル(デフォルト構築・ムーブ後)では何もしない。id 0をバインドするとデフォルトの名前に書き込んでしまう
+    void data(GLenum target, GLsizeiptr size, const void* data, GLenum usage)
+    {
+        if (!registry || !id)
+        {
+            return;
+        }
+        glBindBuffer(target, id);
+        glBufferData(target, size, data, usage);
+        registry->setBytes(GLResourceType::Buffer, id, size);
+        if (data)
+        {
+            registry->addUploadBytes(size);
+        }
+    }
+
+    // glBufferSubDataと同じ
+    void subData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data)
+    {
+        if (!registry || !id)
+        {
+            return;
+        }
+        glBindBuffer(target, id);
+        glBufferSubData(target, offset, size, data);
+        registry->addUploadBytes(size);
+    }
+};
+
+class TextureObject : public GLHandle<GLResourceType::Texture>
+{
+public:
+    TextureObject() = default;
+
+    explicit TextureObject(GLResourceRegistry& registry)
+        : GLHandle(registry)
+    {
+    }
+
+    // glTexImage2Dと同じ。ミップマップレベルごとの大きさを合計して記録する
+    void image2D(GLint level, GLint internalFormat, GLsizei width, GLsizei height,
+        GLenum format, GLenum type, const void* pixels)
+    {
+        // 空のハンドルでは何もしない
+        if (!registry || !id)
+        {
+            return;
+        }
+        glBindTexture(GL_TEXTURE_2D, id);
+        glTexImage2D(GL_TEXTURE_2D, level, internalFormat, width, height, 0, format, type, pixels);
+
+        if ((int)levelBytes.size() <= level)
+        {
+            levelBytes.resize(level + 1, 0);
+        }
+        levelBytes[level] = (long long)width * height * bytesPerTexel(internalFormat);
+        long long total = 0;
+        for (long long bytes : levelBytes)
+        {
+            total += bytes;
+        }
+        registry->setBytes(GLResourceType::Texture, id, total);
+        if (pixels)
+        {
+            registry->addUploadBytes((long long)width * height * bytesPerTexel(internalFormat));
+        }
+    }
+
+private:
+    // ドライバー内部の実際の大きさはわからないので、内部フォーマットから見積もる
+    static int bytesPerTexel(GLint internalFormat)
+    {
+        switch (internalFormat)
+        {
+        case GL_ALPHA: case GL_LUMINANCE: case GL_ALPHA8: case GL_LUMINANCE8: return 1;
+        case GL_LUMINANCE_ALPHA: case GL_LUMINANCE8_ALPHA8: case GL_DEPTH_COMPONENT16: return 2;
+        case GL_RGBA16F_ARB: return 8;
+        case GL_RGB32F_ARB: case GL_RGBA32F_ARB: return 16;
+        default: return 4;  // RGB8もたいていは4バイトに詰められる
+        }
+    }
+
+    std::vector<long long> levelBytes;
+};
+
+
+// シェーダーのコンパイルやリンクに失敗したときにログを表示する
+void printInfoLog(GLuint object, bool isProgram)
+{
+    GLint length = 0;
+    if (isProgram)
+    {
+        glGetProgramiv(object, GL_INFO_LOG_LENGTH, &length);
+    }
+    else
+    {
+        glGetShaderiv(object, GL_INFO_LOG_LENGTH, &length);
+    }
+    if (length <= 1)
+    {
+        return;
+    }
+    std::vector<GLchar> log(length);
+    if (isProgram)
+    {
+        glGetProgramInfoLog(object, length, NULL, &log[0]);
+    }
+    else
+    {
+        glGetShaderInfoLog(object, length, NULL, &log[0]);
+    }
+    fprintf(stderr, "%s\n", &log[0]);
+}
+
+// makeShaderと同じ処理をハンドルで行う。
+// 途中で失敗してもシェーダーオブジェクトとプログラムはデストラクタで削除されるのでリークしない。
+// 失敗したときは空のProgramObjectを返す
+ProgramObject makeProgram(GLResourceRegistry& registry, std::string vertexFileName, std::string fragmentFileName)
+{
+    // シェーダーオブジェクト作成
+    ShaderObject vertShader(registry, GL_VERTEX_SHADER);
+    ShaderObject fragShader(registry, GL_FRAGMENT_SHADER);
+    vertShader.setLabel(vertexFileName);
+    fragShader.setLabel(fragmentFileName);
+
+    // シェーダーコンパイルとリンクの結果用変数
+    GLint compiled, linked;
+
+    /* シェーダーのソースプログラムの読み込み */
+    if (readShaderSource(vertShader.get(), vertexFileName)) return ProgramObject();
+    if (readShaderSource(fragShader.get(), fragmentFileName)) return ProgramObject();
+
+    /* バーテックスシェーダーのソースプログラムのコンパイル */
+    glCompileShader(vertShader.get());
+    glGetShaderiv(vertShader.get(), GL_COMPILE_STATUS, &compiled);
+    if (compiled == GL_FALSE)
+    {
+        fprintf(stderr, "Compile error in vertex shader.\n");
+        printInfoLog(vertShader.get(), false);
+        return ProgramObject();
+    }
+
+    /* フラグメントシェーダーのソースプログラムのコンパイル */
+    glCompileShader(fragShader.get());
+    glGetShaderiv(fragShader.get(), GL_COMPILE_STATUS, &compiled);
+    if (compiled == GL_FALSE)
+    {
+        fprintf(stderr, "Compile error in fragment shader.\n");
+        printInfoLog(fragShader.get(), false);
+        return ProgramObject();
+    }
+
+    /* プログラムオブジェクトの作成 */
+    ProgramObject program(registry);
+    program.setLabel(vertexFileName + " + " + fragmentFileName);
+
+    /* シェーダーオブジェクトのシェーダープログラムへの登録 */
+    glAttachShader(program.get(), vertShader.get());
+    glAttachShader(program.get(), fragShader.get());
+
+    /* シェーダープログラムのリンク */
+    glLinkProgram(program.get());
+    glGetProgramiv(program.get(), GL_LINK_STATUS, &linked);
+    if (linked == GL_FALSE)
+    {
+        fprintf(stderr, "Link error.\n");
+        printInfoLog(program.get(), true);
+        return ProgramObject();
+    }
+
+    /* リンクが終わればシェーダーオブジェクトは不要(ハンドルが破棄されるときに削除される) */
+    glDetachShader(program.get(), vertShader.get());
+    glDetachShader(program.get(), fragShader.get());
+
+    return program;
+}
+
+
+// n x n個の四角形からなる格子(z = 0の平面)
+void makeGrid(int n, std::vector<vec3>& positions, std::vector<GLuint>& indices)
+{
+    positions.clear();
+    indices.clear();
+    for (int y = 0; y <= n; ++y)
+    {
+        for (int x = 0; x <= n; ++x)
+        {
+            positions.push_back(vec3((float)x / n * 2.0f - 1.0f, (float)y / n * 2.0f - 1.0f, 0.0f));
+        }
+    }
+    for (int y = 0; y < n; ++y)
+    {
+        for (int x = 0; x < n; ++x)
+        {
+            GLuint i0 = y * (n + 1) + x;
+            GLuint quad[6] = { i0, i0 + 1, i0 + n + 2, i0, i0 + n + 2, i0 + n + 1 };
+            indices.insert(indices.end(), quad, quad + 6);
+        }
+    }
+}
+
+// メッシュ1つ分のGPUリソース
+struct GridMesh
+{
+    BufferObject indexBuffer;
+    BufferObject positionBuffer;
+    BufferObject colorBuffer;
+    GLsizei indexCount = 0;
+    size_t vertexCount = 0;
+};
+
+GridMesh makeGridMesh(GLResourceRegistry& registry, int n)
+{
+    std::vector<vec3> positions;
+    std::vector<GLuint> indices;
+    makeGrid(n, positions, indices);
+
+    GridMesh mesh;
+    mesh.indexBuffer = BufferObject(registry);
+    mesh.positionBuffer = BufferObject(registry);
+    mesh.colorBuffer = BufferObject(registry);
+    mesh.indexBuffer.setLabel("grid indices");
+    mesh.positionBuffer.setLabel("grid positions");
+    mesh.colorBuffer.setLabel("grid colors");
+
+    mesh.indexBuffer.data(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint) * indices.size(), &indices[0], GL_STATIC_DRAW);
+    mesh.positionBuffer.data(GL_ARRAY_BUFFER, sizeof(vec3) * positions.size(), &positions[0], GL_STATIC_DRAW);
+    // 色は毎フレーム書き換える
+    mesh.colorBuffer.data(GL_ARRAY_BUFFER, sizeof(vec4) * positions.size(), NULL, GL_STREAM_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    mesh.indexCount = indices.size();
+    mesh.vertexCount = positions.size();
+    return mesh;
+}
+
+
+int main()
+{
+    GLint width = 640, height = 480;
+    GLFWwindow* window = initGLFW(width, height);
+
+    GLResourceRegistry registry;
+
+    // ハンドルはregistry.shutdown()より前に破棄されるようにスコープを切る
+    {
+        ProgramObject shader = makeProgram(registry, "shader.vert", "shader.frag");
+
+        GLint positionLocation = glGetAttribLocation(shader.get(), "position");
+        GLint colorLocation = glGetAttribLocation(shader.get(), "color");
+        GLuint matrixID = glGetUniformLocation(shader.get(), "MVP");
+
+        // 一定時間ごとに格子を作り直して、古いバッファが遅延削除される様子を見る
+        const int gridSizes[3] = { 8, 32, 128 };
+        int gridIndex = 0;
+        GridMesh mesh = makeGridMesh(registry, gridSizes[gridIndex]);
+        std::vector<vec4> colors;
+
+        double lastRebuild = glfwGetTime();
+        double lastReport = glfwGetTime();
+
+        // フレームループ
+        while (glfwWindowShouldClose(window) == GL_FALSE)
+        {
+            double now = glfwGetTime();
+            if (now - lastRebuild > 3.0)
+            {
+                gridIndex = (gridIndex + 1) % 3;
+                // 古いメッシュのバッファはムーブ代入で解放が予約され、endFrameで削除される
+                mesh = makeGridMesh(registry, gridSizes[gridIndex]);
+                lastRebuild = now;
+            }
+
+            // 頂点色を更新して転送する(フレームごとの転送量に数えられる)
+            colors.resize(mesh.vertexCount);
+            for (size_t i = 0; i < colors.size(); ++i)
+            {
+                float phase = (float)now * 2.0f + i * 0.05f;
+                colors[i] = vec4(0.5f + 0.5f * std::sin(phase), 0.5f + 0.5f * std::cos(phase), 0.8f, 1.0f);
+            }
+            mesh.colorBuffer.subData(GL_ARRAY_BUFFER, 0, sizeof(vec4) * colors.size(), &colors[0]);
+
+            glUseProgram(shader.get());
+
+            glEnable(GL_DEPTH_TEST);
+            glDepthFunc(GL_LESS);
+            glClearColor(0.2f, 0.2f, 0.2f, 0.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            // 宣言時には単位行列が入っている
+            mat4 modelMat, viewMat, projectionMat;
+
+            // View行列を計算
+            viewMat = glm::lookAt(
+                vec3(2.0, 2.0, 2.0), // ワールド空間でのカメラの座標
+                vec3(0.0, 0.0, 0.0), // 見ている位置の座標
+                vec3(0.0, 0.0, 1.0)  // 上方向を示す。(0,1.0,0)に設定するとy軸が上になります
+            );
+
+            // Projection行列を計算
+            projectionMat = glm::perspective(
+                glm::radians(45.0f), // ズームの度合い(通常90～30)
+                (GLfloat)width / (GLfloat)height,		// アスペクト比
+                0.1f,		// 近くのクリッピング平面
+                100.0f		// 遠くのクリッピング平面
+            );
+
+            // ModelViewProjection行列を計算
+            mat4 mvpMat = projectionMat * viewMat* modelMat;
+            glUniformMatrix4fv(matrixID, 1, GL_FALSE, &mvpMat[0][0]);
+
+            glEnableVertexAttribArray(positionLocation);
+            glBindBuffer(GL_ARRAY_BUFFER, mesh.positionBuffer.get());
+            glVertexAttribPointer(positionLocation, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
+            glEnableVertexAttribArray(colorLocation);
+            glBindBuffer(GL_ARRAY_BUFFER, mesh.colorBuffer.get());
+            glVertexAttribPointer(colorLocation, 4, GL_FLOAT, GL_FALSE, 0, (void*)0);
+
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.indexBuffer.get());
+            glDrawElements(GL_TRIANGLES, mesh.indexCount, GL_UNSIGNED_INT, (void*)0);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+            // ダブルバッファのスワップ
+            glfwSwapBuffers(window);
+            glfwPollEvents();
+
+            // フレームの区切りで削除をまとめて行う
+            registry.endFrame();
+
+            // 実行中の統計を定期的に表示する
+            if (now - lastReport > 1.0)
+            {
+                GLResourceStats stats = registry.stats();
+                printf("buffers %d (%lld bytes), programs %d, upload %lld bytes/frame\n",
+                    stats.live[(int)GLResourceType::Buffer], stats.bytes[(int)GLResourceType::Buffer],
+                    stats.live[(int)GLResourceType::Program], stats.uploadBytesLastFrame);
+                lastReport = now;
+            }
+        }
+    }
+
+    // 残りの削除を済ませて統計を出力する
+    registry.shutdown();
+
+    // GLFWの終了処理
+    glfwTerminate();
+
+    return 0;
+}
\ No newline at end of file
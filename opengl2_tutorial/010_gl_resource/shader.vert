@@ -0,0 +1,16 @@
+#version 120
+
+//
+// shader.vert
+//
+
+attribute vec3 position;
+attribute vec4 color;
+
+uniform mat4 MVP;
+
+void main(void)
+{
+    gl_Position = MVP * vec4(position, 1.0);
+    gl_FrontColor = color;
+}
\ No newline at end of file